@@ -9,13 +9,15 @@
 #include "YnvisibleDriverV5.h"
 #include "YnvisibleEvaluationKit.h"
 
-unsigned int selectedAnimation = 0;
-bool animationChanged = false;
-bool runSelectedAnimation = false;
-bool pauseAnimation = false;              // Pause the current animation.
-bool cancelAnimation = false;            // abort the currently playing animation. Used by long press Start Button or by starting another animation while one is already on-going
+// Shared with the buttons' ISRs
+volatile unsigned int selectedAnimation = 0;
+volatile bool animationChanged = false;
+volatile bool runSelectedAnimation = false;
+volatile bool pauseAnimation = false;              // Pause the current animation.
+volatile bool cancelAnimation = false;            // abort the currently playing animation. Used by long press Start Button or by starting another animation while one is already on-going
 
 bool directToggleState = false;
+bool bootLEDsRunning = true;                      // Boot Up LEDs sequence on-going, see loop()
 
 void setup() {
   // --------------- Main Power DC-DC ---------------
@@ -42,15 +44,23 @@ void setup() {
   attachInterrupt(digitalPinToInterrupt(BTN_DOWN), buttonDownPressedISR, RISING);
   interrupts();
 
-  greenLEDsInit();
-  updateAnimationLEDs(selectedAnimation);
+  greenLEDsBootBegin();           // Runs from loop(), the kit is usable right away
 
   runSelectedAnimation = false;
   evaluationKitInit();
 }
 
 void loop() {
-  
+  evaluationKitPoll();
+
+  if(bootLEDsRunning){
+    if(greenLEDsBootUpdate(millis()) == false && runSelectedAnimation == false){
+      return;
+    }
+    bootLEDsRunning = false;
+    animationChanged = true;        // Show the selected animation
+  }
+
   if(animationChanged){
     updateAnimationLEDs(selectedAnimation);
     animationChanged = false;
@@ -58,7 +68,9 @@ void loop() {
 
   if(runSelectedAnimation){
     digitalWrite(LED_B, HIGH);     // RGB Blue OFF
-    digitalWrite(LED_G, LOW);     // RGB Green ON
+    if(pauseAnimation == false){
+      digitalWrite(LED_G, LOW);     // RGB Green ON, blinks while paused
+    }
     
     switch(selectedAnimation){
       case EVAL_ANIMATION_DIRECT_TOGGLE:
@@ -92,19 +104,11 @@ void loop() {
         animation7SegDotCountDown();
       break;
       case EVAL_ANIMATION_7BARS_COUNT_UP:
-        animation7BarsCountUp();
-      break;
       case EVAL_ANIMATION_7BARS_COUNT_DOWN:
-        animation7BarsCountDown();
-      break;
       case EVAL_ANIMATION_3BARS_COUNT_UP:
-        animation3BarsCountUp();
-      break;
       case EVAL_ANIMATION_3BARS_COUNT_DOWN:
-        animation3BarsCountDown();
-      break;
       case EVAL_ANIMATION_3BARS_MID_TOP_BOT:
-        animation3BarsMidTopBot();
+        animationKeyframes();           // Non-blocking, runs a step each loop
       break;
       default:
         digitalWrite(LED_G, HIGH);      // RGB Green OFF
@@ -119,7 +123,9 @@ void loop() {
       break;
     }
     digitalWrite(LED_R, HIGH);
-    digitalWrite(LED_G, HIGH);     // RGB Green OFF
+    if(pauseAnimation == false){
+      digitalWrite(LED_G, HIGH);     // RGB Green OFF
+    }
   }
   checkAndCancelCurrentAnimation();
 }
@@ -136,31 +142,45 @@ void checkAndCancelCurrentAnimation(void){
     cancelAnimation = false;
     return;
   }
-  while(pauseAnimation){
-    digitalWrite(LED_G, HIGH);
-    delay(DRIVER_ANIMATION_DELAY_PAUSE);
-    digitalWrite(LED_G, LOW);
-    delay(DRIVER_ANIMATION_DELAY_PAUSE);
+  displayAnimationPause(pauseAnimation);    // The keyframes hold after the running Execute, loop() keeps ticking them
+  if(pauseAnimation){
+    pauseLEDUpdate();
   }
 }
 
 /**
- * Check if the animation is canceled
+ * Blink the green LED while the animation is paused. Returns right away.
+ */
+void pauseLEDUpdate(void){
+  static unsigned long lastToggle = 0;
+  static bool ledOn = false;
+
+  if(millis() - lastToggle < DRIVER_ANIMATION_DELAY_PAUSE){
+    return;
+  }
+  lastToggle = millis();
+  ledOn = !ledOn;
+  digitalWrite(LED_G, ledOn ? LOW : HIGH);
+}
+
+/**
+ * Check if the animation is canceled, holding here while it is paused.
+ * Only called by the blocking animations between two Executes, so no display is driven
+ * while holding. The kit's background tasks keep running.
  * @returns TRUE: animation is canceled \
  * @returns FALSE: animation was not canceled
  */
 bool isAnimationCanceled(void){
+  while(pauseAnimation && cancelAnimation == false){
+    evaluationKitPoll();
+    pauseLEDUpdate();
+  }
   if(cancelAnimation){
     digitalWrite(LED_G, HIGH);
     digitalWrite(LED_R, LOW);
     return true;
   }
-  while(pauseAnimation){
-    digitalWrite(LED_G, HIGH);
-    delay(DRIVER_ANIMATION_DELAY_PAUSE);
-    digitalWrite(LED_G, LOW);
-    delay(DRIVER_ANIMATION_DELAY_PAUSE);
-  }
+  digitalWrite(LED_G, LOW);     // RGB Green ON
   return false;
 }
 
@@ -415,105 +435,14 @@ void animation7SegDotCountDown(void){
   display7SegDotRun(EVAL_KIT_7SEG_DOT_MASK_NUM_OF_ANIMATIONS, false);
 }
 
-/******************************* 7 Bars Display *******************************/
-
-/**
- * Count up with the 7 bars display
- */
-void animation7BarsCountUp(void){
-  delayAfterDisplayRun(0);  // Reset timer
-  for(int i = 0; i < 7; i++){
-    if(isAnimationCanceled()){
-      return;
-    }
-    display7BarsSet(i, SEGMENT_STATE_COLOR);
-    delayAfterDisplayRun(EVAL_KIT_7BAR_COUNT_DELAY);
-  }
-  display7BarsClear();
-}
+/************************** Bar Displays (Keyframes) **************************/
 
 /**
- * Count down with the 7 bars display
+ * Play the selected bar display animation, restarting it when it ends.
+ * Returns right away, so buttons and other tasks keep running while the bars change.
  */
-void animation7BarsCountDown(void){
-  delayAfterDisplayRun(0);  // Reset timer
-  for(int i = 6; i >= 0; i--){
-    if(isAnimationCanceled()){
-      return;
-    }
-    display7BarsSet(i, SEGMENT_STATE_COLOR);
-    delayAfterDisplayRun(EVAL_KIT_7BAR_COUNT_DELAY);
+void animationKeyframes(void){
+  if(displayAnimationTick() == true){     // Finished, or not started yet
+    displayAnimationStart(selectedAnimation);
   }
-  display7BarsClear();
-}
-
-/******************************* 3 Bars Display *******************************/
-
-/**
- * Count up with the 3 bars display
- */
-void animation3BarsCountUp(void){
-  delayAfterDisplayRun(0);  // Reset timer
-  for(int i = 0; i < 3 ; i++){
-    if(isAnimationCanceled()){
-      return;
-    }
-    display3BarsSet(i, SEGMENT_STATE_COLOR);
-    delayAfterDisplayRun(EVAL_KIT_3BAR_COUNT_DELAY);
-  }
-  delay(EVAL_KIT_3BAR_COUNT_DELAY);
-  delay(EVAL_KIT_3BAR_COUNT_DELAY);
-
-
-  for(int i = 0; i < 3 ; i++){
-    if(isAnimationCanceled()){
-      return;
-    }
-    display3BarsSet(i, SEGMENT_STATE_BLEACH);
-  }
-  delay(EVAL_KIT_3BAR_COUNT_DELAY);
-}
-
-/**
- * Count down with the 3 bars display
- */
-void animation3BarsCountDown(void){
-  delayAfterDisplayRun(0);  // Reset timer
-  for(int i = 2; i >= 0; i--){
-    if(isAnimationCanceled()){
-      return;
-    }
-    display3BarsSet(i, SEGMENT_STATE_COLOR);
-    delayAfterDisplayRun(EVAL_KIT_3BAR_COUNT_DELAY);
-  }
-  for(int i = 2; i >= 0; i--){
-    if(isAnimationCanceled()){
-      return;
-    }
-    display3BarsSet(i, SEGMENT_STATE_BLEACH);
-  }
-  delay(EVAL_KIT_3BAR_COUNT_DELAY);
-}
-
-/**
- * Turn ON the 3 bars display in the following order:
- *  1. Middle Segment
- *  2. Top Segment
- *  3. Bottom Segment
- */
-void animation3BarsMidTopBot(void){
-  delayAfterDisplayRun(0);  // Reset timer
-  display3BarsSet(1, SEGMENT_STATE_COLOR);
-  delayAfterDisplayRun(EVAL_KIT_3BAR_COUNT_DELAY);
-
-  display3BarsSet(2, SEGMENT_STATE_COLOR);
-  delayAfterDisplayRun(EVAL_KIT_3BAR_COUNT_DELAY);
-
-  display3BarsSet(0, SEGMENT_STATE_COLOR);
-  delayAfterDisplayRun(EVAL_KIT_3BAR_COUNT_DELAY);  
-  
-  display3BarsSet(1, SEGMENT_STATE_BLEACH);
-  display3BarsSet(0, SEGMENT_STATE_BLEACH);
-  display3BarsSet(2, SEGMENT_STATE_BLEACH);
-  delay(EVAL_KIT_3BAR_COUNT_DELAY);
 }
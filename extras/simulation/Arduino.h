@@ -0,0 +1,83 @@
+/*
+	Arduino.h - Minimal Arduino API for building the Ynvisible library on a PC
+	Used by the host simulation only, see YnvisibleSim.h
+*/
+
+#ifndef _YNVISIBLE_SIM_ARDUINO
+#define _YNVISIBLE_SIM_ARDUINO
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#define INPUT 			0
+#define OUTPUT 			1
+#define LOW 				0
+#define HIGH 				1
+
+// Driver v5 pins. The numbers only need to be different from each other
+#define PIN_SEG_1 	1
+#define PIN_SEG_2 	2
+#define PIN_SEG_3 	3
+#define PIN_SEG_4 	4
+#define PIN_SEG_5 	5
+#define PIN_SEG_6 	6
+#define PIN_SEG_7 	7
+#define PIN_SEG_8 	8
+#define PIN_SEG_9 	9
+#define PIN_SEG_10 	10
+#define PIN_SEG_11 	11
+#define PIN_SEG_12 	12
+#define PIN_SEG_13 	13
+#define PIN_SEG_14 	14
+#define PIN_SEG_15 	15
+#define PIN_CE 			16
+
+#define constrain(t_value, t_low, t_high) 	((t_value) < (t_low) ? (t_low) : ((t_value) > (t_high) ? (t_high) : (t_value)))
+
+#define PROGMEM
+#define pgm_read_byte(t_address) 	(*(const uint8_t *)(t_address))
+
+void pinMode(uint32_t t_pin, uint32_t t_mode);
+void digitalWrite(uint32_t t_pin, uint32_t t_value);
+int  analogRead(uint32_t t_pin);
+void analogWrite(uint32_t t_pin, uint32_t t_value);
+void analogReadResolution(int t_bits);
+void analogWriteResolution(int t_bits);
+void delay(unsigned long t_ms);
+unsigned long millis(void);
+void yield(void);
+void noInterrupts(void);
+void interrupts(void);
+
+/**
+ * Text output, prints to stdout
+ */
+class Print
+{
+	public:
+		size_t print(const char * t_text) 	{ return fputs(t_text, stdout) >= 0 ? strlen(t_text) : 0; }
+		size_t print(long t_value) 					{ return printf("%ld", t_value); }
+		size_t print(unsigned long t_value) { return printf("%lu", t_value); }
+		size_t print(int t_value) 					{ return print((long)t_value); }
+		size_t print(unsigned int t_value) 	{ return print((unsigned long)t_value); }
+		template<typename T>
+		size_t println(T t_value) 					{ size_t n = print(t_value); return n + println(); }
+		size_t println(void) 								{ return print("\n"); }
+};
+
+/**
+ * Byte input, e.g. a host-side pipe in place of Serial
+ */
+class Stream : public Print
+{
+	public:
+		virtual int available(void) = 0;
+		virtual int read(void) = 0;
+};
+
+extern Print Serial;
+
+#endif	// _YNVISIBLE_SIM_ARDUINO
@@ -0,0 +1,61 @@
+/*
+	Wire.h - Simulated I2C bus for building the Ynvisible library on a PC
+	Used by the host simulation only, see YnvisibleSim.h
+*/
+
+#ifndef _YNVISIBLE_SIM_WIRE
+#define _YNVISIBLE_SIM_WIRE
+
+#include "Arduino.h"
+
+#define BUFFER_LENGTH 			32
+
+typedef void (*simWireReceiver_t)(uint8_t t_address, const uint8_t * t_data, size_t t_size);	// Receiving board, as its Wire.onReceive() handler
+
+/**
+ * I2C master. endTransmission() hands the written bytes to the receiver set with
+ * simSetReceiver(), in place of a board at the other end of the bus.
+ * simFailTransfer() makes a coming write fail after part of its bytes, as a board
+ * that stops acknowledging in the middle of a chunk.
+ */
+class TwoWire
+{
+	public:
+		void beginTransmission(uint8_t t_address) 	{ m_address = t_address; m_size = 0; }
+		size_t write(uint8_t t_byte) 								{ return write(&t_byte, 1); }
+		size_t write(const uint8_t * t_data, size_t t_size){
+			if(t_size > BUFFER_LENGTH - m_size){
+				t_size = BUFFER_LENGTH - m_size;
+			}
+			memcpy(&m_buffer[m_size], t_data, t_size);
+			m_size += t_size;
+			return t_size;
+		}
+		uint8_t endTransmission(void){
+			bool fail = (m_failIn == 0);
+			size_t size = (fail && m_failAfter < m_size) ? m_failAfter : m_size;
+
+			if(m_failIn >= 0){
+				m_failIn--;
+			}
+			if(m_receiver != nullptr && size > 0){
+				m_receiver(m_address, m_buffer, size);
+			}
+			return fail ? 3 : 0;			// Data NACK
+		}
+
+		void simSetReceiver(simWireReceiver_t t_receiver) 	{ m_receiver = t_receiver; }
+		void simFailTransfer(int t_writes, size_t t_bytes) 	{ m_failIn = t_writes; m_failAfter = t_bytes; }	// Write t_writes from now fails after t_bytes bytes
+
+	private:
+		simWireReceiver_t m_receiver 	{ nullptr };
+		uint8_t m_buffer[BUFFER_LENGTH];
+		size_t m_size 								{ 0 };
+		uint8_t m_address 						{ 0 };
+		int m_failIn 									{ -1 };
+		size_t m_failAfter 						{ 0 };
+};
+
+extern TwoWire Wire;
+
+#endif	// _YNVISIBLE_SIM_WIRE
@@ -0,0 +1,197 @@
+/**
+ * Simulated Electrochromic Displays for host builds of the Ynvisible library
+ *
+ * Implements the driver's hardware access (YnvisibleHAL.h) and the few Arduino functions
+ * used by the rest of the library on top of a simple charge/decay model of each segment.
+ * Time only moves when the library waits, so a simulation runs as fast as the host allows.
+ */
+#include <math.h>
+#include "Arduino.h"
+#include "Wire.h"
+#include "YnvisibleHAL.h"
+#include "YnvisibleSim.h"
+
+struct SIM_Pin{
+	bool 		output;
+	bool 		level;
+	float 	state;							// State of charge, 0 bleached - 1 colored
+};
+
+static SIM_SegmentModel simModel;
+static SIM_Pin simPins[SIM_MAX_PINS];
+static uint16_t simCounterElectrode = 0;		// LSB - DAC code of PIN_CE
+static unsigned long simTime = 0;						// ms
+static float simCharge = 0;									// C
+static float simPeakCurrent = 0;						// A
+
+Print Serial;
+TwoWire Wire;
+
+/**
+ * @brief Open-circuit voltage of a segment
+ */
+static float simOpenCircuitVoltage(float t_state){
+  return simModel.bleachVoltage + (simModel.colorVoltage - simModel.bleachVoltage) * t_state;
+}
+
+static float simCounterElectrodeVoltage(void){
+  return simCounterElectrode * SIM_SUPPLY_VOLTAGE / SIM_DAC_MAX_LSB;
+}
+
+/**
+ * @brief Move the model forward by 1 ms
+ */
+static void simStep(void){
+  const float dt = 0.001f;
+  float counterElectrode = simCounterElectrodeVoltage();
+  float totalCurrent = 0;
+
+  for(int pin = 0; pin < SIM_MAX_PINS; pin++){
+    SIM_Pin & segment = simPins[pin];
+
+    if(pin == PIN_CE){
+      continue;
+    }
+    if(segment.output == false){
+      segment.state += (simModel.restState - segment.state) * (1.0f / simModel.decayTime);
+      continue;
+    }
+
+    float pinVoltage = segment.level ? SIM_SUPPLY_VOLTAGE : 0;
+    float current = (pinVoltage - counterElectrode - simOpenCircuitVoltage(segment.state)) / simModel.resistance;
+
+    if((current > 0 && segment.state >= 1) || (current < 0 && segment.state <= 0)){
+      continue;     // Fully switched, no more charge goes in
+    }
+    segment.state += current * dt / simModel.capacity;
+    segment.state = (segment.state < 0) ? 0 : (segment.state > 1) ? 1 : segment.state;
+    simCharge += fabsf(current) * dt;
+    totalCurrent += fabsf(current);
+  }
+  if(totalCurrent > simPeakCurrent){
+    simPeakCurrent = totalCurrent;
+  }
+  simTime++;
+}
+
+/*********************** SIMULATION CONTROL ************************/
+
+void ynvSimReset(const SIM_SegmentModel& t_model){
+  simModel = t_model;
+  for(int pin = 0; pin < SIM_MAX_PINS; pin++){
+    simPins[pin].output = false;
+    simPins[pin].level = LOW;
+    simPins[pin].state = simModel.restState;
+  }
+  simCounterElectrode = 0;
+  simTime = 0;
+  simCharge = 0;
+  simPeakCurrent = 0;
+}
+
+void ynvSimAdvance(unsigned long t_ms){
+  for(unsigned long i = 0; i < t_ms; i++){
+    simStep();
+  }
+}
+
+float ynvSimGetState(uint32_t t_pin){
+  return (t_pin < SIM_MAX_PINS) ? simPins[t_pin].state : 0;
+}
+
+void ynvSimSetState(uint32_t t_pin, float t_state){
+  if(t_pin < SIM_MAX_PINS){
+    simPins[t_pin].state = t_state;
+  }
+}
+
+bool ynvSimIsDriven(uint32_t t_pin){
+  return (t_pin < SIM_MAX_PINS) ? simPins[t_pin].output : false;
+}
+
+float ynvSimGetDriveVoltage(uint32_t t_pin){
+  if(t_pin >= SIM_MAX_PINS || t_pin == PIN_CE || simPins[t_pin].output == false){
+    return 0;
+  }
+  return (simPins[t_pin].level ? SIM_SUPPLY_VOLTAGE : 0) - simCounterElectrodeVoltage();
+}
+
+float ynvSimGetCharge(void){
+  return simCharge;
+}
+
+float ynvSimGetPeakCurrent(void){
+  return simPeakCurrent;
+}
+
+void ynvSimClearCounters(void){
+  simCharge = 0;
+  simPeakCurrent = 0;
+}
+
+/*********************** DRIVER HARDWARE ACCESS ************************/
+
+void ynvHalPinMode(uint32_t t_pin, uint32_t t_mode){
+  if(t_pin < SIM_MAX_PINS){
+    simPins[t_pin].output = (t_mode == OUTPUT);
+  }
+}
+
+void ynvHalDigitalWrite(uint32_t t_pin, uint32_t t_value){
+  if(t_pin < SIM_MAX_PINS){
+    simPins[t_pin].level = (t_value != LOW);
+  }
+}
+
+/**
+ * @brief Sample a pin
+ *
+ * A segment in High-Impedance reads the Counter Electrode voltage plus its open-circuit voltage.
+ */
+int ynvHalAnalogRead(uint32_t t_pin){
+  if(t_pin >= SIM_MAX_PINS){
+    return 0;
+  }
+  if(t_pin == PIN_CE){
+    return simCounterElectrode;
+  }
+  if(simPins[t_pin].output){
+    return simPins[t_pin].level ? SIM_DAC_MAX_LSB : 0;
+  }
+
+  float voltage = simCounterElectrodeVoltage() + simOpenCircuitVoltage(simPins[t_pin].state);
+  int lsb = (int)lroundf(voltage * SIM_DAC_MAX_LSB / SIM_SUPPLY_VOLTAGE);
+  return (lsb < 0) ? 0 : (lsb > SIM_DAC_MAX_LSB) ? SIM_DAC_MAX_LSB : lsb;
+}
+
+void ynvHalAnalogWrite(uint32_t t_pin, uint32_t t_value){
+  if(t_pin == PIN_CE){
+    simCounterElectrode = t_value;
+  }
+}
+
+void ynvHalDelay(unsigned long t_ms){
+  ynvSimAdvance(t_ms);
+}
+
+unsigned long ynvHalMillis(void){
+  return simTime;
+}
+
+void ynvHalYield(void){
+  ynvSimAdvance(1);     // The driver polls in a loop, let the model run meanwhile
+}
+
+/*********************** ARDUINO API ************************/
+
+void pinMode(uint32_t t_pin, uint32_t t_mode) { ynvHalPinMode(t_pin, t_mode); }
+void digitalWrite(uint32_t t_pin, uint32_t t_value) { ynvHalDigitalWrite(t_pin, t_value); }
+int  analogRead(uint32_t t_pin) { return ynvHalAnalogRead(t_pin); }
+void analogWrite(uint32_t t_pin, uint32_t t_value) { ynvHalAnalogWrite(t_pin, t_value); }
+void analogReadResolution(int) {}
+void analogWriteResolution(int) {}
+void delay(unsigned long t_ms) { ynvHalDelay(t_ms); }
+unsigned long millis(void) { return ynvHalMillis(); }
+void yield(void) { ynvHalYield(); }
+void noInterrupts(void) {}
+void interrupts(void) {}
@@ -0,0 +1,44 @@
+/*
+	YnvisibleSim.h - Simulated Electrochromic Displays for host builds of the Ynvisible library
+	Build with YNV_ECD_HOST defined, see benchmark.cpp
+*/
+
+#ifndef _YNVISIBLE_SIM
+#define _YNVISIBLE_SIM
+
+#include "Arduino.h"
+
+#define SIM_MAX_PINS 					32
+#define SIM_SUPPLY_VOLTAGE 		3.0			// V
+#define SIM_DAC_MAX_LSB 			1023		// 10 bit ADC and DAC, as set by YNV_ECD
+
+/**
+ * Electrical model of one segment.
+ *
+ * The segment is a cell between its pin and the Counter Electrode. Its state of charge goes from
+ * 0 (bleached) to 1 (colored), and its open-circuit voltage moves linearly between bleachVoltage
+ * and colorVoltage with it. When the pin drives the cell, the current is
+ * (pin voltage - Counter Electrode voltage - open-circuit voltage) / resistance.
+ * When the pin is in High-Impedance the state decays towards restState.
+ */
+struct SIM_SegmentModel{
+	float 	resistance 			{ 330.0f };			// Ohm - Series resistance of the segment
+	float 	capacity 				{ 0.001f };			// C - Charge to go from bleached to colored
+	float 	colorVoltage 		{ 1.2f };				// V - Open-circuit voltage when fully colored
+	float 	bleachVoltage 	{ -0.7f };			// V - Open-circuit voltage when fully bleached
+	float 	restState 			{ 0.5f };				// State the segments decay to when not driven
+	float 	decayTime 			{ 3600000.0f };	// ms - Time constant of the decay
+};
+
+void 	ynvSimReset(const SIM_SegmentModel& t_model = SIM_SegmentModel());			// All pins in High-Impedance, segments at restState, time 0
+void 	ynvSimAdvance(unsigned long t_ms);																				// Let time pass, as delay() does
+
+float ynvSimGetState(uint32_t t_pin);											// State of charge of a segment, 0 - 1
+void 	ynvSimSetState(uint32_t t_pin, float t_state);
+bool 	ynvSimIsDriven(uint32_t t_pin);										// Pin set as an output, i.e. not in High-Impedance
+float ynvSimGetDriveVoltage(uint32_t t_pin);							// V - Pin minus Counter Electrode voltage, 0 in High-Impedance
+float ynvSimGetCharge(void);															// C - Charge moved by all segments since ynvSimReset() or ynvSimClearCounters()
+float ynvSimGetPeakCurrent(void);													// A - Highest total current of all segments, in 1 ms steps
+void 	ynvSimClearCounters(void);
+
+#endif	// _YNVISIBLE_SIM
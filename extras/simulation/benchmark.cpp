@@ -0,0 +1,131 @@
+/**
+ * Host benchmark of the Ynvisible driver, on the simulated displays of YnvisibleSim.h
+ *
+ * Runs each Evaluation Kit display, with its config from evaluationKitInit(), through
+ * a startup, a full Color and a full Bleach update and a Refresh after the segments decayed,
+ * and reports the simulated time, charge and refresh retries of each step.
+ * Each display runs in every benchMode: fixed pulses, ECD_Config.chargeBudgetDrive and
+ * staggered ECD_Config.driveGroups.
+ * The absolute values depend on SIM_SegmentModel; use them to compare driver changes.
+ *
+ * Build and run from the library folder:
+ * 	g++ -std=gnu++11 -O2 -DYNV_ECD_HOST -DYNV_ECD_STATS -Iextras/simulation -Isrc \
+ * 		extras/simulation/benchmark.cpp extras/simulation/YnvisibleSim.cpp \
+ * 		src/YnvisibleECD.cpp src/YnvisibleADC.cpp src/YnvisibleEvaluationKit.cpp \
+ * 		src/YnvisibleAnimation.cpp src/YnvisibleFont.cpp src/YnvisibleSupply.cpp -o ynv_benchmark
+ * 	./ynv_benchmark
+ */
+#include <stdio.h>
+#include "Arduino.h"
+#include "YnvisibleECD.h"
+#include "YnvisibleEvaluationKit.h"
+#include "YnvisibleSim.h"
+
+#if !defined(YNV_ECD_HOST) || !defined(YNV_ECD_STATS)
+#error "Build the benchmark with -DYNV_ECD_HOST -DYNV_ECD_STATS"
+#endif
+
+#define BENCH_DECAY_TIME 		1800000UL			// ms - Time left to decay before the Refresh step
+
+extern YNV_ECD ecdEvalKitSingle;
+extern YNV_ECD ecdEvalKit7SegDot;
+extern YNV_ECD ecdEvalKit15SegNeg;
+extern YNV_ECD ecdEvalKit15SegDot;
+extern YNV_ECD ecdEvalKit3Bars;
+extern YNV_ECD ecdEvalKit7Bars;
+
+struct BenchDisplay{
+	const char * 	name;
+	YNV_ECD * 		display;
+	int 					numberOfSegments;
+};
+
+struct BenchMode{
+	const char * 	name;
+	bool 					chargeBudgetDrive;
+	uint8_t 			driveGroups;
+};
+
+static const BenchMode benchModes[] = {
+	{ "fixed",   false, 1 },
+	{ "budget",  true,  1 },
+	{ "groups3", false, 3 },
+};
+
+static const BenchDisplay benchDisplays[] = {
+	{ "Single",   &ecdEvalKitSingle,   EVAL_KIT_SINGLE_NUM_SEGMENTS },
+	{ "7SegDot",  &ecdEvalKit7SegDot,  EVAL_KIT_7SEG_DOT_NUM_SEGMENTS },
+	{ "15SegNeg", &ecdEvalKit15SegNeg, EVAL_KIT_15SEG_NEGATIVE_NUM_SEGMENTS },
+	{ "15SegDot", &ecdEvalKit15SegDot, EVAL_KIT_15SEG_DOT_NUM_SEGMENTS },
+	{ "3Bars",    &ecdEvalKit3Bars,    EVAL_KIT_3BARS_NUM_SEGMENTS },
+	{ "7Bars",    &ecdEvalKit7Bars,    EVAL_KIT_7BARS_NUM_SEGMENTS },
+};
+
+/**
+ * @brief Print the time, charge, peak current and refresh statistics since the last call
+ */
+static void benchReport(const char * t_display, const char * t_mode, const char * t_step, YNV_ECD & t_display_, unsigned long t_start){
+	ECD_Stats stats = t_display_.getStats();
+	unsigned long refreshTime = stats.stateTime[ECD_STATE_REFRESH_SETTLE] + stats.stateTime[ECD_STATE_REFRESH_BLEACH_SETTLE] +
+															stats.stateTime[ECD_STATE_REFRESH_BLEACH_PULSE] + stats.stateTime[ECD_STATE_REFRESH_BLEACH_WAIT] +
+															stats.stateTime[ECD_STATE_REFRESH_COLOR_SETTLE] + stats.stateTime[ECD_STATE_REFRESH_COLOR_PULSE] +
+															stats.stateTime[ECD_STATE_REFRESH_COLOR_WAIT];
+
+	printf("%-9s %-7s %-8s %8lu %8lu %10.1f %7.1f %7lu %5u/%-3d %6lu\n", t_display, t_mode, t_step, millis() - t_start, refreshTime,
+				 ynvSimGetCharge() * 1e6, ynvSimGetPeakCurrent() * 1e3, (unsigned long)stats.refreshPulses, stats.maxRefreshRetries, MAX_REFRESH_RETRIES,
+				 (unsigned long)stats.retryCapHits);
+
+	t_display_.resetStats();
+	ynvSimClearCounters();
+}
+
+int main(){
+	evaluationKitInit();
+
+	printf("%-9s %-7s %-8s %8s %8s %10s %7s %7s %9s %6s\n", "display", "mode", "step", "total ms", "refr ms", "charge uC", "peak mA",
+				 "pulses", "retries", "capped");
+
+	for(const BenchMode & mode : benchModes)
+	for(const BenchDisplay & bench : benchDisplays){
+		YNV_ECD & display = *bench.display;
+		ecdSegmentMask_t allSegments = (1ul << bench.numberOfSegments) - 1;
+		ECD_Config config = display.getConfig();
+		unsigned long start;
+
+		config.chargeBudgetDrive = mode.chargeBudgetDrive;
+		config.driveGroups = mode.driveGroups;
+		display.setConfig(config);
+
+		ynvSimReset();
+		display.restoreState(0);		// Forget the previous display, they share the pins
+		display.resetStats();
+
+		start = millis();
+		display.setFrame(allSegments);
+		display.executeDisplay();
+		display.setFrame(0);
+		display.executeDisplay();
+		benchReport(bench.name, mode.name, "begin", display, start);
+
+		start = millis();
+		display.setFrame(allSegments);
+		display.executeDisplay();
+		benchReport(bench.name, mode.name, "color", display, start);
+
+		start = millis();
+		display.setFrame(0);
+		display.executeDisplay();
+		benchReport(bench.name, mode.name, "bleach", display, start);
+
+		display.setFrame(allSegments);
+		display.executeDisplay();
+		ynvSimAdvance(BENCH_DECAY_TIME);
+		display.resetStats();
+		ynvSimClearCounters();
+
+		start = millis();
+		display.refreshDisplay();
+		benchReport(bench.name, mode.name, "refresh", display, start);
+	}
+	return 0;
+}
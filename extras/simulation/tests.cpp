@@ -0,0 +1,349 @@
+/**
+ * Host tests of the Ynvisible driver, on the simulated displays of YnvisibleSim.h
+ * and the simulated I2C bus of Wire.h
+ *
+ * Each test drives a display through a sequence that once misbehaved and checks the
+ * result on the simulated pins. The program prints one line per failed check and
+ * returns the number of failures, 0 when every test passes.
+ *
+ * Build and run from the library folder:
+ * 	g++ -std=gnu++11 -O2 -DYNV_ECD_HOST -Iextras/simulation -Isrc \
+ * 		extras/simulation/tests.cpp extras/simulation/YnvisibleSim.cpp \
+ * 		src/YnvisibleECD.cpp src/YnvisibleADC.cpp src/YnvisibleECDGroup.cpp \
+ * 		src/YnvisibleSignageKit.cpp -o ynv_tests
+ * 	./ynv_tests
+ */
+#include <stdio.h>
+#include <math.h>
+#include "Arduino.h"
+#include "YnvisibleECD.h"
+#include "YnvisibleECDGroup.h"
+#include "YnvisibleSignageKit.h"
+#include "YnvisibleSim.h"
+#include "Wire.h"
+
+#if !defined(YNV_ECD_HOST)
+#error "Build the tests with -DYNV_ECD_HOST"
+#endif
+
+#define TEST_DRIVE_MARGIN 		0.1f				// V - Allowed over the highest drive voltage of an undisturbed Execute
+
+#define TEST_CHECK(t_condition) 	testCheck((t_condition), #t_condition, __func__, __LINE__)
+
+static int testFailures = 0;
+static int testPins[3] = {PIN_SEG_1, PIN_SEG_2, PIN_SEG_3};
+static int testGroupPins[2] = {PIN_SEG_4, PIN_SEG_5};
+static YNV_SIGNAGE_I2C_PARSER * testReceiver = nullptr;
+static int testFrames = 0;
+
+static void testCheck(bool t_condition, const char * t_text, const char * t_test, int t_line){
+	if(t_condition == false){
+		printf("FAIL %s:%d %s\n", t_test, t_line, t_text);
+		testFailures++;
+	}
+}
+
+/**
+ * @brief Voltage across the most driven segment right now
+ */
+static float testDriveVoltage(void){
+	float highest = 0;
+
+	for(int pin : testPins){
+		float voltage = fabsf(ynvSimGetDriveVoltage(pin));
+		if(voltage > highest){
+			highest = voltage;
+		}
+	}
+	return highest;
+}
+
+/**
+ * @brief Run the display until it's idle, 1 ms at a time
+ *
+ * @return V - highest voltage across a driven segment meanwhile
+ */
+static float testRunUntilIdle(YNV_ECD_BASE & t_display){
+	float highest = 0;
+
+	while(t_display.update(millis()) == false){
+		float voltage = testDriveVoltage();
+		if(voltage > highest){
+			highest = voltage;
+		}
+		ynvSimAdvance(1);
+	}
+	return highest;
+}
+
+/**
+ * @brief Start a Color Execute of the first segment and run it into its Color pulse
+ *
+ * @return V - highest voltage across a driven segment of the same Execute, undisturbed
+ */
+static float testStartColorPulse(YNV_ECD & t_display, ecdOperation_t & t_operation){
+	ynvSimReset();
+	t_display.restoreState(0);
+	t_display.setFrame(1);
+	t_display.beginExecute();
+	float undisturbed = testRunUntilIdle(t_display);
+
+	ynvSimReset();
+	t_display.restoreState(0);
+	t_display.setFrame(1);
+	t_operation = t_display.beginExecute();
+	for(int i = 0; i < 100; i++){
+		t_display.update(millis());
+		ynvSimAdvance(1);
+	}
+	return undisturbed;
+}
+
+/**
+ * beginExecute() while an Execute is driving must not leave the first pulse running
+ * under the Counter Electrode of the second one.
+ */
+static void testBeginExecuteWhileBusy(void){
+	YNV_ECD display(3, testPins);
+	ecdOperation_t operation;
+	float undisturbed = testStartColorPulse(display, operation);
+
+	TEST_CHECK(display.isBusy());
+	display.setFrame(0);
+	TEST_CHECK(display.beginExecute() == ECD_NO_OPERATION);
+	TEST_CHECK(display.isOperationDone(operation) == false);
+
+	float highest = testRunUntilIdle(display);
+	TEST_CHECK(highest <= undisturbed + TEST_DRIVE_MARGIN);
+	TEST_CHECK(ynvSimGetState(PIN_SEG_1) > 0.9f);
+
+	// The new frame is still pending and is applied once the display is idle
+	TEST_CHECK(display.beginExecute() != ECD_NO_OPERATION);
+	testRunUntilIdle(display);
+	TEST_CHECK(ynvSimGetState(PIN_SEG_1) < 0.1f);
+	TEST_CHECK(ynvSimIsDriven(PIN_SEG_1) == false);
+}
+
+/**
+ * beginRefresh() while an Execute is driving must not restart the state machine.
+ */
+static void testBeginRefreshWhileBusy(void){
+	YNV_ECD display(3, testPins);
+	ecdOperation_t operation;
+	float undisturbed = testStartColorPulse(display, operation);
+
+	TEST_CHECK(display.isBusy());
+	TEST_CHECK(display.beginRefresh() == ECD_NO_OPERATION);
+	TEST_CHECK(display.isOperationDone(operation) == false);
+
+	float highest = testRunUntilIdle(display);
+	TEST_CHECK(highest <= undisturbed + TEST_DRIVE_MARGIN);
+	TEST_CHECK(ynvSimGetState(PIN_SEG_1) > 0.9f);
+	TEST_CHECK(ynvSimIsDriven(PIN_SEG_1) == false);
+}
+
+/**
+ * A STOP queued during a group Execute must release that display at once, and a STOP
+ * queued while the group was idle must not abort the next group Execute.
+ */
+static void testGroupCommandQueue(void){
+	YNV_ECD display(3, testPins);
+	YNV_ECD other(2, testGroupPins);
+	YNV_ECD_GROUP group;
+	ECD_CommandQueue queue;
+
+	ynvSimReset();
+	display.restoreState(0);
+	other.restoreState(0);
+	display.setCommandQueue(&queue);
+	group.addDisplay(&display);
+	group.addDisplay(&other);
+
+	queue.push(ECD_COMMAND_STOP);			// Stale, nothing is driving
+	display.setFrame(1);
+	other.setFrame(1);
+	TEST_CHECK(group.beginExecute());
+	for(int i = 0; i < 100; i++){
+		group.update(millis());
+		ynvSimAdvance(1);
+	}
+	TEST_CHECK(ynvSimIsDriven(PIN_SEG_1));
+
+	queue.push(ECD_COMMAND_STOP);
+	group.update(millis());
+	TEST_CHECK(ynvSimIsDriven(PIN_SEG_1) == false);
+	TEST_CHECK(ynvSimIsDriven(PIN_SEG_4));			// The other display carries on
+	TEST_CHECK(queue.isEmpty());
+
+	while(group.update(millis()) == false){
+		ynvSimAdvance(1);
+	}
+	TEST_CHECK(ynvSimGetState(PIN_SEG_4) > 0.9f);
+}
+
+/**
+ * A group must not start a shared pulse while one of its displays runs its own Execute.
+ */
+static void testGroupWithBusyDisplay(void){
+	YNV_ECD display(3, testPins);
+	YNV_ECD other(2, testGroupPins);
+	YNV_ECD_GROUP group;
+	ecdOperation_t operation;
+	float undisturbed = testStartColorPulse(display, operation);
+
+	other.restoreState(0);
+	group.addDisplay(&display);
+	group.addDisplay(&other);
+
+	other.setFrame(3);
+	TEST_CHECK(group.beginExecute() == false);
+	TEST_CHECK(group.beginRefresh() == false);
+	TEST_CHECK(group.isBusy() == false);
+
+	float highest = testRunUntilIdle(display);
+	TEST_CHECK(highest <= undisturbed + TEST_DRIVE_MARGIN);
+	TEST_CHECK(ynvSimIsDriven(PIN_SEG_4) == false);
+
+	TEST_CHECK(group.beginExecute() == true);		// Free once the display is idle
+	while(group.update(millis()) == false){
+		ynvSimAdvance(1);
+	}
+	TEST_CHECK(ynvSimGetState(PIN_SEG_4) > 0.9f);
+}
+
+/**
+ * @brief Refresh a display with one faded segment, the first one, and the others bleached
+ *
+ * @return true if the display went through t_state
+ */
+static bool testRefreshGoesThrough(ecdSegmentMask_t t_frame, float t_fadedState, ecdDriveState_e t_state){
+	YNV_ECD display(3, testPins);
+	bool seen = false;
+
+	ynvSimReset();
+	display.restoreState(t_frame);
+	ynvSimSetState(PIN_SEG_1, t_fadedState);
+	ynvSimSetState(PIN_SEG_2, 0);			// Fully bleached
+	ynvSimSetState(PIN_SEG_3, 0);
+	TEST_CHECK(display.beginRefresh() != ECD_NO_OPERATION);
+	while(display.update(millis()) == false){
+		seen |= (display.getDriveState() == t_state);
+		ynvSimAdvance(1);
+	}
+	return seen;
+}
+
+/**
+ * A Refresh must not wait for the Counter Electrode to settle for a phase with no segment to refresh.
+ */
+static void testRefreshSkipsEmptyPhases(void){
+	TEST_CHECK(testRefreshGoesThrough(1, 0.3f, ECD_STATE_REFRESH_COLOR_PULSE));
+	TEST_CHECK(testRefreshGoesThrough(1, 0.3f, ECD_STATE_REFRESH_BLEACH_SETTLE) == false);
+	TEST_CHECK(testRefreshGoesThrough(0, 0.8f, ECD_STATE_REFRESH_BLEACH_PULSE));
+	TEST_CHECK(testRefreshGoesThrough(0, 0.8f, ECD_STATE_REFRESH_COLOR_SETTLE) == false);
+}
+
+/**
+ * @brief Signage frame of 2 displays with 2 bytes each, Start TX bytes in its Display Data
+ */
+static void testBuildFrame(YNV_SIGNAGE_I2C_STATIC_MESSAGE & t_message){
+	const char data[4] = {SIGN_MESSAGE_START_TX, 0x11, SIGN_MESSAGE_START_TX, 0x22};
+
+	t_message.setNumberOfDisplays(2);
+	t_message.setMessageMode(SIGN_MODE_SEGMENTS);
+	t_message.setLength(SIGN_MESSAGE_MIN_LENGTH + sizeof(data));
+	t_message.setDisplayData(data, SIGN_MESSAGE_DATA_START, sizeof(data));
+}
+
+/**
+ * @brief Feed the first t_size bytes of a frame, all at time t_now
+ *
+ * @return true if a byte completed a valid frame
+ */
+static bool testFeed(YNV_SIGNAGE_I2C_PARSER & t_parser, const uint8_t * t_frame, uint16_t t_size, unsigned long t_now){
+	bool ok = false;
+
+	for(uint16_t i = 0; i < t_size; i++){
+		ok |= t_parser.feed(t_frame[i], t_now);
+	}
+	return ok;
+}
+
+/**
+ * A frame cut short by the transmitter must not swallow the next full frame.
+ */
+static void testParserAfterTruncatedFrame(void){
+	YNV_SIGNAGE_I2C_MESSAGE_T<4> message;
+	YNV_SIGNAGE_I2C_PARSER_T<2> parser;
+	uint8_t slice[2] = {0, 0};
+
+	testBuildFrame(message);
+	const uint8_t * frame = message.getMessage();
+	uint16_t size = message.getTotalSize();
+	parser.setPosition(1);
+
+	TEST_CHECK(testFeed(parser, frame, SIGN_MESSAGE_DATA_START + 1, 0) == false);
+	TEST_CHECK(testFeed(parser, frame, size, SIGN_PARSER_BYTE_TIMEOUT + 1));
+	TEST_CHECK(parser.getErrorCount() == 1);
+	TEST_CHECK(parser.readSlice(slice, sizeof(slice)) == 2);
+	TEST_CHECK(slice[0] == SIGN_MESSAGE_START_TX && slice[1] == 0x22);
+
+	// Gaps shorter than the timeout, e.g. between two chunks, keep the frame
+	TEST_CHECK(testFeed(parser, frame, SIGN_MESSAGE_DATA_START + 1, 1000) == false);
+	TEST_CHECK(testFeed(parser, frame + SIGN_MESSAGE_DATA_START + 1, size - SIGN_MESSAGE_DATA_START - 1, 1000 + SIGN_PARSER_BYTE_TIMEOUT));
+	TEST_CHECK(parser.getErrorCount() == 1);
+}
+
+static void testReceive(uint8_t t_address, const uint8_t * t_data, size_t t_size){
+	(void)t_address;
+	for(size_t i = 0; i < t_size; i++){
+		if(testReceiver->feed(t_data[i])){
+			testFrames++;
+		}
+	}
+}
+
+/**
+ * A message sent right after a transfer failed in the middle of a frame must reach the receiver.
+ */
+static void testTransmitAfterFailedChunk(void){
+	YNV_SIGNAGE_I2C_MESSAGE_T<4> message;
+	YNV_SIGNAGE_I2C_PARSER_T<2> parser;
+	YNV_SIGNAGE_I2C_TX tx(0x10);
+
+	ynvSimReset();
+	testBuildFrame(message);
+	testReceiver = &parser;
+	testFrames = 0;
+	Wire.simSetReceiver(testReceive);
+	tx.setChunkSize(4);
+
+	Wire.simFailTransfer(1, 2);				// Second chunk, after 2 of its bytes
+	TEST_CHECK(tx.transmit(message.getMessage(), message.getTotalSize()) == false);
+	TEST_CHECK(tx.transmit(message.getMessage(), message.getTotalSize()));
+	TEST_CHECK(testFrames == 1);
+	TEST_CHECK(parser.getErrorCount() == 1);
+
+	// A cancelled transfer too
+	TEST_CHECK(tx.beginTransmit(message));
+	tx.update();
+	tx.cancel();
+	TEST_CHECK(tx.transmit(message.getMessage(), message.getTotalSize()));
+	TEST_CHECK(testFrames == 2);
+
+	Wire.simSetReceiver(nullptr);
+	testReceiver = nullptr;
+}
+
+int main(){
+	testBeginExecuteWhileBusy();
+	testBeginRefreshWhileBusy();
+	testGroupCommandQueue();
+	testGroupWithBusyDisplay();
+	testRefreshSkipsEmptyPhases();
+	testParserAfterTruncatedFrame();
+	testTransmitAfterFailedChunk();
+
+	printf("%s, %d failure(s)\n", (testFailures == 0) ? "PASS" : "FAIL", testFailures);
+	return testFailures;
+}
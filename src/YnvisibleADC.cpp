@@ -0,0 +1,114 @@
+/**
+ * Batched ADC sampling for Ynvisible Electrochromic Displays
+ * 
+ * On SAMD21 the ADC is enabled once for the whole scan and only the input mux
+ * changes between pins, instead of enabling, discarding a conversion and
+ * disabling the ADC on every analogRead() call.
+ * The segment pins don't map to consecutive ADC channels, so the hardware
+ * input scan (INPUTSCAN) can't be used and the channels are switched in software.
+ */
+#include "Arduino.h"
+#include "YnvisibleADC.h"
+
+#if defined(YNV_ADC_FAST_SCAN)
+#include "wiring_private.h"
+#endif
+
+#if defined(YNV_ADC_FAST_SCAN) || defined(YNV_ADC_SUPPLY_CHANNEL)
+static inline void adcSync(void){
+  while(ADC->STATUS.bit.SYNCBUSY == 1);
+}
+
+static inline uint16_t adcConvert(void){
+  adcSync();
+  ADC->INTFLAG.reg = ADC_INTFLAG_RESRDY;
+  ADC->SWTRIG.bit.START = 1;
+  while(ADC->INTFLAG.bit.RESRDY == 0);
+  return ADC->RESULT.reg;
+}
+#endif
+
+/**
+ * @brief Sample a list of analog pins in one pass
+ * 
+ * @param t_pins pins to sample
+ * @param t_count number of pins
+ * @param t_samples [LSB] - output buffer, one sample per pin
+ */
+void ynvAnalogScan(const int * t_pins, int t_count, uint16_t * t_samples){
+#if defined(YNV_ADC_FAST_SCAN)
+  for(int i = 0; i < t_count; i++){
+    if(g_APinDescription[t_pins[i]].ulADCChannelNumber != No_ADC_Channel){
+      pinPeripheral(t_pins[i], PIO_ANALOG);
+    }
+  }
+
+  adcSync();
+  ADC->CTRLA.bit.ENABLE = 1;
+  adcConvert();             // The first conversion after enabling the ADC must not be used
+
+  for(int i = 0; i < t_count; i++){
+    EAnalogChannel channel = g_APinDescription[t_pins[i]].ulADCChannelNumber;
+    if(channel == No_ADC_Channel){
+      t_samples[i] = 0;
+      continue;
+    }
+    adcSync();
+    ADC->INPUTCTRL.bit.MUXPOS = channel;
+    t_samples[i] = adcConvert();
+  }
+
+  adcSync();
+  ADC->CTRLA.bit.ENABLE = 0;
+
+  // Give the pins back to the PORT, as pinMode(INPUT) would
+  for(int i = 0; i < t_count; i++){
+    const PinDescription & pin = g_APinDescription[t_pins[i]];
+    PORT->Group[pin.ulPort].PINCFG[pin.ulPin].reg = (uint8_t)(PORT_PINCFG_INEN);
+    PORT->Group[pin.ulPort].DIRCLR.reg = (uint32_t)(1ul << pin.ulPin);
+  }
+#else
+  for(int i = 0; i < t_count; i++){
+    t_samples[i] = ynvHalAnalogRead(t_pins[i]);
+  }
+#endif
+}
+
+/**
+ * @brief Measure the Supply Voltage
+ * 
+ * Samples the 1/4 VDDIO channel with the 12 bit, 1.0V internal reference.
+ * The reference, input and resolution used by analogRead() are restored afterwards.
+ * 
+ * @return mV, 0 if not available on this board
+ */
+uint16_t ynvReadSupplyMillivolts(void){
+#if defined(YNV_ADC_SUPPLY_CHANNEL)
+  adcSync();
+  uint8_t refCtrl = ADC->REFCTRL.reg;
+  uint32_t inputCtrl = ADC->INPUTCTRL.reg;
+  uint16_t ctrlB = ADC->CTRLB.reg;
+
+  ADC->REFCTRL.reg = ADC_REFCTRL_REFSEL_INT1V;
+  ADC->INPUTCTRL.reg = ADC_INPUTCTRL_MUXPOS_SCALEDIOVCC | ADC_INPUTCTRL_MUXNEG_GND | ADC_INPUTCTRL_GAIN_1X;
+  adcSync();
+  ADC->CTRLB.bit.RESSEL = ADC_CTRLB_RESSEL_12BIT_Val;
+
+  adcSync();
+  ADC->CTRLA.bit.ENABLE = 1;
+  adcConvert();             // The first conversion after changing the reference must not be used
+  uint32_t result = adcConvert();
+
+  adcSync();
+  ADC->CTRLA.bit.ENABLE = 0;
+  ADC->REFCTRL.reg = refCtrl;
+  ADC->INPUTCTRL.reg = inputCtrl;
+  adcSync();
+  ADC->CTRLB.reg = ctrlB;
+  adcSync();
+
+  return (uint16_t)(result * 4000 / 4096);     // 1/4 of VDDIO, full scale is 1.0V
+#else
+  return 0;
+#endif
+}
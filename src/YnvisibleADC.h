@@ -0,0 +1,38 @@
+/*
+	YnvisibleADC.h - Batched ADC sampling for Ynvisible's Electrochromic Displays
+	For Driver 5.x Hardware
+*/
+
+#ifndef _YNVISIBLE_ADC
+#define _YNVISIBLE_ADC
+
+#include "Arduino.h"
+#include "YnvisibleHAL.h"
+
+// SAMD21: sample with a register-level loop instead of analogRead(). Define YNV_ADC_NO_FAST_SCAN to disable it.
+#if defined(ARDUINO_ARCH_SAMD) && !defined(__SAMD51__) && !defined(YNV_ADC_NO_FAST_SCAN)
+#define YNV_ADC_FAST_SCAN
+#endif
+
+// SAMD21: the Supply Voltage can be measured through the ADC's internal 1/4 VDDIO channel
+#if defined(ARDUINO_ARCH_SAMD) && !defined(__SAMD51__)
+#define YNV_ADC_SUPPLY_CHANNEL
+#endif
+
+/**
+ * Sample a list of analog pins in one pass
+ * @param t_pins pins to sample
+ * @param t_count number of pins
+ * @param t_samples [LSB] - output buffer, one sample per pin
+ * @note the pins are left in INPUT (High-Impedance) mode
+ */
+void ynvAnalogScan(const int * t_pins, int t_count, uint16_t * t_samples);
+
+/**
+ * Measure the Supply Voltage (VDDIO) against the internal 1.0V reference
+ * @return mV, 0 if the board has no internal supply channel
+ * @note the ADC settings used by analogRead() are restored
+ */
+uint16_t ynvReadSupplyMillivolts(void);
+
+#endif	// _YNVISIBLE_ADC
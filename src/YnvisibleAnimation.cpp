@@ -0,0 +1,139 @@
+/**
+ * Non-blocking keyframe animations for Ynvisible Electrochromic Displays
+ * 
+ * Each keyframe is applied with YNV_ECD.setFrame() and YNV_ECD.beginExecute(),
+ * so only the segments that change between keyframes are driven.
+ */
+#include "Arduino.h"
+#include "YnvisibleAnimation.h"
+
+/**
+ * @brief Start playing an animation
+ * 
+ * @param t_display display to animate
+ * @param t_keyframes keyframe table, must stay valid while the animation runs
+ * @param t_numKeyframes number of keyframes in the table
+ * @param t_loop restart from the first keyframe after the last one
+ * @return false if the table is empty. A running animation is canceled first.
+ */
+bool YNV_ANIMATION::begin(YNV_ECD_BASE & t_display, const ECD_Keyframe * t_keyframes, uint16_t t_numKeyframes, bool t_loop){
+  if(t_keyframes == nullptr || t_numKeyframes == 0){
+    return false;
+  }
+  if(isRunning()){
+    cancel();
+  }
+
+  m_display = &t_display;
+  m_keyframes = t_keyframes;
+  m_numKeyframes = t_numKeyframes;
+  m_loop = t_loop;
+  m_paused = false;
+  m_keyframeIndex = 0;
+
+  startKeyframe(ynvHalMillis());
+  return true;
+}
+
+/**
+ * @brief Advance the animation
+ * 
+ * @param t_now ms - current time, usually millis()
+ * @return true when the animation is finished, canceled or was never started
+ */
+bool YNV_ANIMATION::tick(unsigned long t_now){
+  switch(m_state){
+    case ECD_ANIMATION_IDLE:
+      return true;
+
+    case ECD_ANIMATION_DRIVING:
+      if(m_display->update(t_now) == false){
+        return false;
+      }
+      m_state = ECD_ANIMATION_HOLD;
+      // fall through
+
+    case ECD_ANIMATION_HOLD:
+      if(m_paused){
+        m_pausedElapsed = t_now - m_keyframeStart;
+        m_state = ECD_ANIMATION_PAUSED;
+        return false;
+      }
+      if((t_now - m_keyframeStart) < m_keyframes[m_keyframeIndex].duration){
+        return false;
+      }
+      m_keyframeIndex++;
+      if(m_keyframeIndex >= m_numKeyframes){
+        if(m_loop == false){
+          m_state = ECD_ANIMATION_IDLE;
+          return true;
+        }
+        m_keyframeIndex = 0;
+      }
+      startKeyframe(t_now);
+      return false;
+
+    case ECD_ANIMATION_PAUSED:
+      if(m_paused){
+        return false;
+      }
+      m_keyframeStart = t_now - m_pausedElapsed;     // Hold only what was left of the keyframe
+      m_state = ECD_ANIMATION_HOLD;
+      return false;
+
+    case ECD_ANIMATION_CLEARING:
+      if(m_display->update(t_now) == false){
+        return false;
+      }
+      m_state = ECD_ANIMATION_IDLE;
+      return true;
+  }
+  return true;
+}
+
+/**
+ * @brief Cancel the animation
+ * 
+ * A running Execute is stopped right away and the segments are left disabled.
+ * 
+ * @param t_clearDisplay bleach all segments afterwards. The bleach runs from tick(),
+ * the animation reads as running until it's done.
+ */
+void YNV_ANIMATION::cancel(bool t_clearDisplay){
+  if(m_state == ECD_ANIMATION_IDLE){
+    return;
+  }
+
+  m_display->cancel(m_operation);       // Other displays are not affected
+
+  if(t_clearDisplay){
+    m_display->setAllSegmentsBleach();
+    m_operation = m_display->beginExecute();
+    m_state = ECD_ANIMATION_CLEARING;
+    return;
+  }
+  m_state = ECD_ANIMATION_IDLE;
+}
+
+/**
+ * @brief Pause or resume the animation
+ * 
+ * A running Execute is not interrupted: tick() keeps driving it to the end and
+ * then holds the display before the next keyframe until the animation is resumed.
+ * The remaining duration of the keyframe is kept across the pause.
+ * 
+ * @param t_paused true to pause, false to resume
+ */
+void YNV_ANIMATION::pause(bool t_paused){
+  m_paused = t_paused;
+}
+
+/**
+ * @brief Apply the current keyframe
+ */
+void YNV_ANIMATION::startKeyframe(unsigned long t_now){
+  m_keyframeStart = t_now;
+  m_display->setFrame(m_keyframes[m_keyframeIndex].frame);
+  m_operation = m_display->beginExecute();
+  m_state = ECD_ANIMATION_DRIVING;
+}
@@ -0,0 +1,67 @@
+/*
+	YnvisibleAnimation.h - Non-blocking keyframe animations for Ynvisible's Electrochromic Displays
+	For Driver 5.x Hardware
+*/
+
+#ifndef _YNVISIBLE_ANIMATION
+#define _YNVISIBLE_ANIMATION
+
+#include "Arduino.h"
+#include "YnvisibleECD.h"
+
+enum ecdAnimationState_e{
+	ECD_ANIMATION_IDLE = 0,
+	ECD_ANIMATION_DRIVING,				// Keyframe being applied with a non-blocking Execute
+	ECD_ANIMATION_HOLD,						// Waiting for the keyframe duration to end
+	ECD_ANIMATION_PAUSED,					// Paused between keyframes, see YNV_ANIMATION.pause()
+	ECD_ANIMATION_CLEARING				// Canceled, bleaching all segments
+};
+
+/**
+ * One step of an animation
+ * frame: segments in the Color state, bit i = segment i (see YNV_ECD.setFrame())
+ * duration: ms from the start of this keyframe to the start of the next one, the Execute time included
+ */
+struct ECD_Keyframe{
+	ecdSegmentMask_t frame;
+	uint16_t duration;
+};
+
+/**
+ * Plays a table of keyframes on a display without blocking.
+ * Call tick() from loop(): each call only advances the display's state machine,
+ * so the sketch can handle buttons, serial commands or sensors in between.
+ */
+class YNV_ANIMATION
+{
+	public:
+		YNV_ANIMATION() {}
+
+		bool begin(YNV_ECD_BASE & t_display, const ECD_Keyframe * t_keyframes, uint16_t t_numKeyframes, bool t_loop = false);
+		bool tick(unsigned long t_now);						// Returns true when the animation is not running
+		bool poll() { return tick(ynvHalMillis()); }
+		void cancel(bool t_clearDisplay = false);	// Stop now. Optionally bleach the display, finished by tick()
+		void pause(bool t_paused);								// Hold after the running Execute, keep calling tick()
+
+		bool isRunning() const { return m_state != ECD_ANIMATION_IDLE; }
+		ecdAnimationState_e getState() const { return m_state; }
+		bool isPaused() const { return m_paused; }
+		uint16_t getKeyframeIndex() const { return m_keyframeIndex; }
+
+	private:
+		YNV_ECD_BASE * 				m_display 				{ nullptr };
+		const ECD_Keyframe * 	m_keyframes 			{ nullptr };
+		uint16_t 							m_numKeyframes 		{ 0 };
+		uint16_t 							m_keyframeIndex 	{ 0 };
+		bool 									m_loop 						{ false };
+		bool 									m_paused 					{ false };
+
+		ecdAnimationState_e 	m_state 					{ ECD_ANIMATION_IDLE };
+		unsigned long 				m_keyframeStart 	{ 0 };
+		unsigned long 				m_pausedElapsed 	{ 0 };						// Keyframe time already held when paused
+		ecdOperation_t 				m_operation 			{ ECD_NO_OPERATION };		// Execute of the current keyframe
+
+		void startKeyframe(unsigned long t_now);
+};
+
+#endif	// _YNVISIBLE_ANIMATION
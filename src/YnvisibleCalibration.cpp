@@ -0,0 +1,270 @@
+/**
+ * Non-volatile calibration store for Ynvisible Electrochromic Displays
+ * 
+ * Each record is protected by a magic number, a version and a checksum, so a
+ * blank or outdated area is simply ignored and the display falls back to
+ * YNV_ECD.begin() and the config given by the sketch.
+ */
+#include "Arduino.h"
+#include "YnvisibleCalibration.h"
+
+#if defined(YNV_CALIBRATION_SAMD_FLASH)
+/**
+ * Internal flash backend
+ * One record per flash row, so saving one display only erases its own row.
+ */
+static_assert(sizeof(ECD_CalibrationRecord) <= CALIBRATION_FLASH_ROW_SIZE, "ECD_CalibrationRecord must fit a flash row");
+
+__attribute__((__aligned__(CALIBRATION_FLASH_ROW_SIZE)))
+static const uint8_t calibrationFlash[CALIBRATION_MAX_RECORDS * CALIBRATION_FLASH_ROW_SIZE] = { };
+
+static inline void nvmWaitReady(void){
+  while(NVMCTRL->INTFLAG.bit.READY == 0);
+}
+
+static bool flashRead(uint8_t t_slot, ECD_CalibrationRecord * t_record){
+  const volatile uint8_t * src = &calibrationFlash[t_slot * CALIBRATION_FLASH_ROW_SIZE];
+  uint8_t * dst = (uint8_t *)t_record;
+
+  for(uint16_t i = 0; i < sizeof(ECD_CalibrationRecord); i++){
+    dst[i] = src[i];        // volatile: the compiler can't assume the blank initial content
+  }
+  return true;
+}
+
+static bool flashWrite(uint8_t t_slot, const ECD_CalibrationRecord * t_record){
+  volatile uint32_t * dst = (volatile uint32_t *)&calibrationFlash[t_slot * CALIBRATION_FLASH_ROW_SIZE];
+  uint32_t words[(sizeof(ECD_CalibrationRecord) + 3) / 4] = { };
+  const uint16_t pageWords = NVMCTRL_PAGE_SIZE / 4;
+
+  memcpy(words, t_record, sizeof(ECD_CalibrationRecord));
+
+  // Erase the row
+  NVMCTRL->CTRLB.bit.MANW = 1;
+  NVMCTRL->ADDR.reg = ((uint32_t)(uintptr_t)dst) / 2;     // Address in 16-bit words
+  NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_ER;
+  nvmWaitReady();
+
+  // Write it page by page
+  for(uint16_t i = 0; i < sizeof(words) / 4; i += pageWords){
+    NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_PBC;
+    nvmWaitReady();
+
+    for(uint16_t j = i; j < i + pageWords && j < sizeof(words) / 4; j++){
+      dst[j] = words[j];
+    }
+
+    NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_WP;
+    nvmWaitReady();
+  }
+  return true;
+}
+#endif
+
+static bool noBackendRead(uint8_t, ECD_CalibrationRecord *){
+  return false;
+}
+
+static bool noBackendWrite(uint8_t, const ECD_CalibrationRecord *){
+  return false;
+}
+
+YNV_CALIBRATION_STORE::YNV_CALIBRATION_STORE(){
+#if defined(YNV_CALIBRATION_SAMD_FLASH)
+  m_backend = { flashRead, flashWrite };
+#else
+  m_backend = { noBackendRead, noBackendWrite };
+#endif
+}
+
+/**
+ * @brief Initialize a display from its stored calibration
+ * 
+ * Restores the config and limits when a record exists for t_displayId. The limits are
+ * computed again if the Supply Voltage changed since they were saved (see
+ * YNV_SUPPLY_MONITOR). If the stored segment state is valid, it's taken
+ * as is and YNV_ECD.begin() is skipped; otherwise YNV_ECD.begin() runs as usual.
+ * 
+ * @param t_displayId ID of the display
+ * @param t_display display to initialize
+ * @return true if the stored state was used and YNV_ECD.begin() was skipped
+ */
+bool YNV_CALIBRATION_STORE::begin(uint16_t t_displayId, YNV_ECD_BASE& t_display){
+  if(resume(t_displayId, t_display) == true){
+    return true;
+  }
+  t_display.begin();
+  return false;
+}
+
+/**
+ * @brief Restore the calibration and the last known state of a display, without driving it
+ * 
+ * Same as YNV_CALIBRATION_STORE.begin(), but YNV_ECD.begin() is never called.
+ * Use it with YNV_ECD_GROUP.startupDisplays(), which starts up only the displays
+ * that couldn't be resumed.
+ * 
+ * @param t_displayId ID of the display
+ * @param t_display display to restore
+ * @return true if the stored state was restored. Otherwise the display's state is left undefined
+ */
+bool YNV_CALIBRATION_STORE::resume(uint16_t t_displayId, YNV_ECD_BASE& t_display){
+  ECD_CalibrationRecord record;
+  int slot = findSlot(t_displayId, &record);
+
+  if(slot < 0){
+    return false;
+  }
+
+  restoreCalibration(record, t_display);
+
+  if(record.stateValid == false){
+    return false;
+  }
+
+  t_display.restoreState(record.frame);
+
+  // The state is only valid until the display is driven again
+  record.stateValid = false;
+  record.checkSum = checkSum(&record);
+  m_backend.write(slot, &record);
+  return true;
+}
+
+/**
+ * @brief Restore the config and the limits of a display
+ * 
+ * The limits are computed again if the Supply Voltage changed since they were saved.
+ * 
+ * @return false if there's no valid record for this display
+ */
+bool YNV_CALIBRATION_STORE::load(uint16_t t_displayId, YNV_ECD_BASE& t_display){
+  ECD_CalibrationRecord record;
+
+  if(findSlot(t_displayId, &record) < 0){
+    return false;
+  }
+  restoreCalibration(record, t_display);
+  return true;
+}
+
+/**
+ * @brief Store the config and limits of a display
+ * 
+ * @note each call erases a flash row, don't call it on every Execute
+ */
+bool YNV_CALIBRATION_STORE::save(uint16_t t_displayId, const YNV_ECD_BASE& t_display){
+  return writeRecord(t_displayId, t_display, false);
+}
+
+/**
+ * @brief Store the config, limits and current segment state of a display
+ * 
+ * Call it when the display won't be driven until the next boot, e.g. before powering off.
+ */
+bool YNV_CALIBRATION_STORE::saveState(uint16_t t_displayId, const YNV_ECD_BASE& t_display){
+  if(t_display.isBusy() || t_display.hasPendingChanges()){
+    return false;         // State not settled yet
+  }
+  return writeRecord(t_displayId, t_display, true);
+}
+
+/**
+ * @brief Remove the record of a display
+ */
+bool YNV_CALIBRATION_STORE::erase(uint16_t t_displayId){
+  ECD_CalibrationRecord record;
+  int slot = findSlot(t_displayId, &record);
+
+  if(slot < 0){
+    return true;
+  }
+  memset((void *)&record, 0xFF, sizeof(record));
+  return m_backend.write(slot, &record);
+}
+
+/*********************** PRIVATE FUNCTIONS ***********************/
+
+/**
+ * @brief Give a stored config to a display
+ * 
+ * The stored limits are used as they are if they were computed for the display's
+ * current Supply Voltage, otherwise they are computed again from the config.
+ */
+void YNV_CALIBRATION_STORE::restoreCalibration(const ECD_CalibrationRecord& t_record, YNV_ECD_BASE& t_display){
+  if(t_record.supplyVoltage == t_display.getSupplyVoltage()){
+    t_display.setCalibration(t_record.config, t_record.limits);
+  }
+  else{
+    t_display.setConfig(t_record.config);
+  }
+}
+
+/**
+ * @brief Find the record of a display
+ * @return slot of the record, -1 if there's none
+ */
+int YNV_CALIBRATION_STORE::findSlot(uint16_t t_displayId, ECD_CalibrationRecord * t_record){
+  for(int slot = 0; slot < CALIBRATION_MAX_RECORDS; slot++){
+    if(m_backend.read(slot, t_record) && isValid(t_record) && t_record->displayId == t_displayId){
+      return slot;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Find a slot without a valid record
+ * @return slot, -1 if all are used
+ */
+int YNV_CALIBRATION_STORE::findFreeSlot(){
+  ECD_CalibrationRecord record;
+
+  for(int slot = 0; slot < CALIBRATION_MAX_RECORDS; slot++){
+    if(m_backend.read(slot, &record) == false || isValid(&record) == false){
+      return slot;
+    }
+  }
+  return -1;
+}
+
+bool YNV_CALIBRATION_STORE::writeRecord(uint16_t t_displayId, const YNV_ECD_BASE& t_display, bool t_stateValid){
+  ECD_CalibrationRecord record;
+  int slot = findSlot(t_displayId, &record);
+
+  if(slot < 0){
+    slot = findFreeSlot();
+  }
+  if(slot < 0){
+    return false;
+  }
+
+  memset((void *)&record, 0, sizeof(record));       // Padding bytes are part of the checksum
+  record.magic = CALIBRATION_MAGIC;
+  record.version = CALIBRATION_VERSION;
+  record.displayId = t_displayId;
+  record.config = t_display.getConfig();
+  record.limits = t_display.getLimits();
+  record.supplyVoltage = t_display.getSupplyVoltage();
+  record.frame = t_display.getFrame();
+  record.stateValid = t_stateValid;
+  record.checkSum = checkSum(&record);
+
+  return m_backend.write(slot, &record);
+}
+
+uint16_t YNV_CALIBRATION_STORE::checkSum(const ECD_CalibrationRecord * t_record){
+  const uint8_t * data = (const uint8_t *)t_record;
+  uint16_t sum = 0;
+
+  for(uint16_t i = 0; i < offsetof(ECD_CalibrationRecord, checkSum); i++){
+    sum += data[i];
+  }
+  return sum;
+}
+
+bool YNV_CALIBRATION_STORE::isValid(const ECD_CalibrationRecord * t_record){
+  return t_record->magic == CALIBRATION_MAGIC && t_record->version == CALIBRATION_VERSION && t_record->checkSum == checkSum(t_record);
+}
+
+/********************* END PRIVATE FUNCTIONS **********************/
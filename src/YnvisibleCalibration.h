@@ -0,0 +1,82 @@
+/*
+	YnvisibleCalibration.h - Non-volatile calibration store for Ynvisible's Electrochromic Displays
+	For Driver 5.x Hardware
+*/
+
+#ifndef _YNVISIBLE_CALIBRATION
+#define _YNVISIBLE_CALIBRATION
+
+#include "Arduino.h"
+#include "YnvisibleECD.h"
+
+#define CALIBRATION_MAX_RECORDS			6						// One record per display ID
+#define CALIBRATION_MAGIC						0x594E4331	// "YNC1"
+#define CALIBRATION_VERSION					3						// Change when ECD_CalibrationRecord changes
+
+// SAMD21: keep the records in a reserved area of the internal flash. Define YNV_CALIBRATION_NO_FLASH to disable it.
+#if defined(ARDUINO_ARCH_SAMD) && !defined(__SAMD51__) && !defined(YNV_CALIBRATION_NO_FLASH)
+#define YNV_CALIBRATION_SAMD_FLASH
+#define CALIBRATION_FLASH_ROW_SIZE	256					// Bytes - smallest erasable block
+#endif
+
+/**
+ * What is stored for one display
+ */
+struct ECD_CalibrationRecord{
+	uint32_t 					magic;
+	uint16_t 					version;
+	uint16_t 					displayId;
+	ECD_Config 				config;
+	ECD_Limits 				limits;
+	float 						supplyVoltage;				// V - the limits are only used again at this Supply Voltage
+	ecdSegmentMask_t 	frame;								// Segments in the Color state when the record was saved
+	bool 							stateValid;						// frame still matches the display
+	uint16_t 					checkSum;							// Sum of all the previous bytes
+};
+
+/**
+ * Storage for the records. The slots go from 0 to CALIBRATION_MAX_RECORDS-1.
+ * read() returns false if the slot can't be read, write() if it can't be written.
+ */
+struct ECD_CalibrationBackend{
+	bool (* read)(uint8_t t_slot, ECD_CalibrationRecord * t_record);
+	bool (* write)(uint8_t t_slot, const ECD_CalibrationRecord * t_record);
+};
+
+/**
+ * Saves each display's config, its precomputed limits and its segment state, keyed
+ * by a display ID. At boot begin() restores them instead of recomputing the limits,
+ * and skips the Color -> Bleach sequence of YNV_ECD.begin() when the saved state is still valid.
+ * 
+ * A restored state is used once: it's invalidated at boot, so call saveState() again
+ * before powering off (e.g. before releasing MCU_PWR_ON).
+ * 
+ * On SAMD21 the records are kept in the internal flash, erased on each sketch upload.
+ * Other boards need a backend, see setBackend().
+ */
+class YNV_CALIBRATION_STORE
+{
+	public:
+		YNV_CALIBRATION_STORE();
+
+		void setBackend(const ECD_CalibrationBackend& t_backend) { m_backend = t_backend; }
+
+		bool begin(uint16_t t_displayId, YNV_ECD_BASE& t_display);			// Restore or initialize the display. Returns true if begin() was skipped
+		bool resume(uint16_t t_displayId, YNV_ECD_BASE& t_display);		// Like begin(), without calling YNV_ECD.begin()
+		bool load(uint16_t t_displayId, YNV_ECD_BASE& t_display);			// Restore config and limits only
+		bool save(uint16_t t_displayId, const YNV_ECD_BASE& t_display);
+		bool saveState(uint16_t t_displayId, const YNV_ECD_BASE& t_display);	// Save and mark the segment state as valid
+		bool erase(uint16_t t_displayId);
+
+	private:
+		ECD_CalibrationBackend m_backend;
+
+		void restoreCalibration(const ECD_CalibrationRecord& t_record, YNV_ECD_BASE& t_display);
+		int  findSlot(uint16_t t_displayId, ECD_CalibrationRecord * t_record);
+		int  findFreeSlot();
+		bool writeRecord(uint16_t t_displayId, const YNV_ECD_BASE& t_display, bool t_stateValid);
+		static uint16_t checkSum(const ECD_CalibrationRecord * t_record);
+		static bool isValid(const ECD_CalibrationRecord * t_record);
+};
+
+#endif	// _YNVISIBLE_CALIBRATION
@@ -11,42 +11,47 @@ const unsigned int greenLEDsPinList[7] = {LED_1, LED_2, LED_3, LED_4, LED_5, LED
 
 /**
  * Green LED Animations Table
- * boolean matrix indicating the LEDs state for each Display animation.
+ * LED states for each Display animation, bit 0 = LED_1 ... bit 6 = LED_7.
  * LED is active LOW
- * LOW  (0) - LED ON
- * HIGH (1) - LED OFF
+ * 0 - LED ON
+ * 1 - LED OFF
  */
-const bool greenLEDsAnimationTable[28][7] = {
-  {0, 1, 1, 1, 1, 1, 1}, // Animation 1
-  {1, 0, 1, 1, 1, 1, 1}, // Animation 2
-  {1, 1, 0, 1, 1, 1, 1}, // Animation 3
-  {1, 1, 1, 0, 1, 1, 1}, // Animation 4
-  {1, 1, 1, 1, 0, 1, 1}, // Animation 5
-  {1, 1, 1, 1, 1, 0, 1}, // Animation 6
-  {1, 1, 1, 1, 1, 1, 0}, // Animation 7
-  {0, 0, 1, 1, 1, 1, 1}, // Animation 8
-  {0, 1, 0, 1, 1, 1, 1}, // Animation 9
-  {0, 1, 1, 0, 1, 1, 1}, // Animation 10
-  {0, 1, 1, 1, 0, 1, 1}, // Animation 11
-  {0, 1, 1, 1, 1, 0, 1}, // Animation 12
-  {0, 1, 1, 1, 1, 1, 0}, // Animation 13
-  {0, 0, 0, 1, 1, 1, 1}, // Animation 14
-  {0, 0, 1, 0, 1, 1, 1}, // Animation 15
-  {0, 0, 1, 1, 0, 1, 1}, // Animation 16
-  {0, 0, 1, 1, 1, 0, 1}, // Animation 17
-  {0, 0, 1, 1, 1, 1, 0}, // Animation 18
-  {0, 0, 0, 0, 1, 1, 1}, // Animation 19
-  {0, 0, 0, 1, 0, 1, 1}, // Animation 20
-  {0, 0, 0, 1, 1, 0, 1}, // Animation 21
-  {0, 0, 0, 1, 1, 1, 0}, // Animation 22
-  {0, 0, 0, 0, 0, 1, 1}, // Animation 23
-  {0, 0, 0, 0, 1, 0, 1}, // Animation 24
-  {0, 0, 0, 0, 1, 1, 0}, // Animation 25
-  {0, 0, 0, 0, 0, 0, 1}, // Animation 26
-  {0, 0, 0, 0, 0, 1, 0}, // Animation 27
-  {0, 0, 0, 0, 0, 0, 0}  // Animation 28
+const uint8_t greenLEDsAnimationTable[28] PROGMEM = {
+  0x7E, // Animation 1
+  0x7D, // Animation 2
+  0x7B, // Animation 3
+  0x77, // Animation 4
+  0x6F, // Animation 5
+  0x5F, // Animation 6
+  0x3F, // Animation 7
+  0x7C, // Animation 8
+  0x7A, // Animation 9
+  0x76, // Animation 10
+  0x6E, // Animation 11
+  0x5E, // Animation 12
+  0x3E, // Animation 13
+  0x78, // Animation 14
+  0x74, // Animation 15
+  0x6C, // Animation 16
+  0x5C, // Animation 17
+  0x3C, // Animation 18
+  0x70, // Animation 19
+  0x68, // Animation 20
+  0x58, // Animation 21
+  0x38, // Animation 22
+  0x60, // Animation 23
+  0x50, // Animation 24
+  0x30, // Animation 25
+  0x40, // Animation 26
+  0x20, // Animation 27
+  0x00  // Animation 28
 };
 
+// Boot Up sequence progress, see greenLEDsBootUpdate()
+static uint8_t bootLEDsStep = DRIVER_BOOT_UP_NUM_STEPS;
+static unsigned long bootLEDsStepTime = 0;
+static unsigned long bootLEDsWait = 0;
+
 /**
  * @brief Turn ON all Green LEDs (L1 - L7)
  * 
@@ -97,17 +102,65 @@ void greenLEDsAllOff(unsigned int t_delay){
  * 
  * Initialize the LEDs PINs and do an 
  * ON/OFF sequence with a specific delay 
+ * @note this function blocks until the sequence is done. Use greenLEDsBootBegin()
+ * and greenLEDsBootUpdate() to run it while the displays start up.
  */
 void greenLEDsInit(void){
+  greenLEDsBootBegin();
+  while(greenLEDsBootUpdate(millis()) == false){
+    yield();
+  }
+}
+
+/**
+ * @brief Start the Boot Up sequence without blocking
+ * 
+ * Initialize the LEDs PINs and turn on the first LED.
+ * Call greenLEDsBootUpdate() periodically until it returns true.
+ */
+void greenLEDsBootBegin(void){
   // --------------- Green LEDs Pin Setup ---------------
   for(int i = 0; i < 7; i++){
     pinMode(greenLEDsPinList[i], OUTPUT);
     digitalWrite(greenLEDsPinList[i], HIGH);
   }
 
-  greenLEDsAllOn(DRIVER_BOOT_UP_SEQUENCE_DELAY/3);    // Turn all On
-  delay(DRIVER_BOOT_UP_SEQUENCE_DELAY * 2);        // Wait a bit
-  greenLEDsAllOff(DRIVER_BOOT_UP_SEQUENCE_DELAY);   // Turn all Off
+  bootLEDsStep = 0;
+  bootLEDsWait = 0;
+  bootLEDsStepTime = millis();
+  greenLEDsBootUpdate(bootLEDsStepTime);
+}
+
+/**
+ * @brief Advance the Boot Up sequence
+ * 
+ * Turns ON the LEDs from left to right, waits a bit and turns them OFF from right to left,
+ * with the same timing as greenLEDsInit().
+ * 
+ * @param t_now current time in ms, usually millis()
+ * @return true when the sequence is done
+ */
+bool greenLEDsBootUpdate(unsigned long t_now){
+  while(bootLEDsStep < DRIVER_BOOT_UP_NUM_STEPS){
+    if(t_now - bootLEDsStepTime < bootLEDsWait){
+      return false;
+    }
+    bootLEDsStepTime = t_now;
+
+    if(bootLEDsStep < 7){
+      digitalWrite(greenLEDsPinList[bootLEDsStep], LOW);        // Turn On, left to right
+      bootLEDsWait = DRIVER_BOOT_UP_SEQUENCE_DELAY/3;
+      if(bootLEDsStep == 6){
+        bootLEDsWait += DRIVER_BOOT_UP_SEQUENCE_DELAY * 2;       // Wait a bit with all On
+      }
+    }
+    else{
+      digitalWrite(greenLEDsPinList[13 - bootLEDsStep], HIGH);  // Turn Off, right to left
+      bootLEDsWait = DRIVER_BOOT_UP_SEQUENCE_DELAY;
+    }
+    bootLEDsStep++;
+  }
+  return true;
 }
 
 /**
@@ -116,7 +169,9 @@ void greenLEDsInit(void){
  * @param t_selectedAnimation Number of the currently active animation
  */
 void updateAnimationLEDs(unsigned int t_selectedAnimation) {
+  uint8_t ledStates = pgm_read_byte(&greenLEDsAnimationTable[t_selectedAnimation]);
+
   for (int i = 0; i < 7; i++) {
-    digitalWrite(greenLEDsPinList[i], greenLEDsAnimationTable[t_selectedAnimation][i]);  // Turn ON with LOW, OFF with HIGH
+    digitalWrite(greenLEDsPinList[i], (ledStates >> i) & 1);  // Turn ON with LOW, OFF with HIGH
   }
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <Arduino.h>
 
 #define DRIVER_BOOT_UP_SEQUENCE_DELAY   100      // ms - delay between each LED operation for boot-up sequence
+#define DRIVER_BOOT_UP_NUM_STEPS        14       // 7 LEDs On, then 7 LEDs Off
 
 #define DRIVER_BUTTON_DEBOUNCE_MS       50
 #define DRIVER_BUTTON_LONG_PRESS_MS     1000
@@ -31,6 +32,21 @@ void greenLEDsAllOff(unsigned int t_delay);
  */
 void greenLEDsInit(void);
 
+/**
+ * Start the Boot Up green LEDs Sequence without blocking
+ * @details
+ * Same sequence as greenLEDsInit(). Call greenLEDsBootUpdate() periodically
+ * (e.g. while the displays start up) until it returns true.
+ */
+void greenLEDsBootBegin(void);
+
+/**
+ * Advance the Boot Up green LEDs Sequence
+ * @param t_now current time in ms, usually millis()
+ * @return true when the sequence is done
+ */
+bool greenLEDsBootUpdate(unsigned long t_now);
+
 /**
  * Change the Green LEDs to match the currently selected animation.
  * @param t_selectedAnimation Currently selected animation
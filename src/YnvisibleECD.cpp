@@ -4,6 +4,7 @@
  */
 #include "Arduino.h"
 #include "YnvisibleECD.h"
+#include "YnvisibleADC.h"
 
 
 /*********************** PUBLIC FUNCTIONS ************************/
@@ -11,15 +12,45 @@
 /**
  * @brief Ynvisible's Electrochromic Display driver
  * 
- * @param t_numberOfSegments display's number of segments
+ * @param t_numberOfSegments display's number of segments, up to MAX_NUMBER_OF_SEGMENTS
  * @param t_segments array of segments' pins
  */
 YNV_ECD::YNV_ECD(int t_numberOfSegments, int t_segments[])        // Constructor
 {
+  if(t_numberOfSegments > MAX_NUMBER_OF_SEGMENTS){
+    t_numberOfSegments = MAX_NUMBER_OF_SEGMENTS;
+  }
+  attachSegments(t_numberOfSegments, t_segments, m_storage.buffers());
+}
+
+/**
+ * @brief Set up the display's pins and per-segment storage
+ * 
+ * @param t_numberOfSegments display's number of segments
+ * @param t_segments array of segments' pins
+ * @param t_buffers per-segment storage, with room for t_numberOfSegments segments
+ */
+void YNV_ECD_BASE::attachSegments(int t_numberOfSegments, const int * t_segments, const ECD_SegmentBuffers& t_buffers)
+{
+  m_segmentPinsList = t_buffers.pins;
+  m_segmentSamples = t_buffers.samples;
+  m_historySamples = t_buffers.history;
+  m_historyCount = t_buffers.historyCount;
+  m_segmentCharge = t_buffers.charge;
+#if defined(YNV_ECD_FAST_GPIO)
+  m_segmentPort = t_buffers.port;
+  m_segmentPortBit = t_buffers.portBit;
+#endif
+#if defined(YNV_ECD_STATS)
+  m_sampleMin = t_buffers.sampleMin;
+  m_sampleMax = t_buffers.sampleMax;
+#endif
+
   m_counterElectrodePin = PIN_CE;
-  pinMode(m_counterElectrodePin, OUTPUT);
+  ynvHalPinMode(m_counterElectrodePin, OUTPUT);
 
   m_numberOfSegments = t_numberOfSegments;
+  m_allSegmentsMask = (m_numberOfSegments >= 32) ? 0xFFFFFFFF : ((1ul << m_numberOfSegments) - 1);
 
   analogReadResolution(ADC_DAC_RESOLUTION);
   analogWriteResolution(ADC_DAC_RESOLUTION);
@@ -28,18 +59,29 @@ YNV_ECD::YNV_ECD(int t_numberOfSegments, int t_segments[])        // Constructor
   {
     m_segmentPinsList[i] = t_segments[i];
 
-    pinMode(m_segmentPinsList[i], INPUT);
+    ynvHalPinMode(m_segmentPinsList[i], INPUT);
+
+#if defined(YNV_ECD_FAST_GPIO)
+    m_segmentPort[i] = g_APinDescription[m_segmentPinsList[i]].ulPort;
+    m_segmentPortBit[i] = 1ul << g_APinDescription[m_segmentPinsList[i]].ulPin;
+    m_portAllSegments[m_segmentPort[i]] |= m_segmentPortBit[i];
+#endif
 
-    m_currentState[i] = SEGMENT_STATE_UNDEFINED;
-    m_nextState[i] = SEGMENT_STATE_UNDEFINED;
+    m_historyCount[i] = 0;
+    m_segmentCharge[i] = 0;
   }
+
+  updateRefreshLimits();      // Limits and DAC codes for the default config
+#if defined(YNV_ECD_STATS)
+  resetStats();
+#endif
 }
 
 /**
  * This method initializes the display by setting all segments to the color state and then bleaching them.
  * It is typically called at the beginning of the program to prepare the display for use.
  */
-void YNV_ECD::begin()
+void YNV_ECD_BASE::begin()
 {
   //Color all segments
   for(int i = 0; i < m_numberOfSegments; i++){
@@ -61,234 +103,495 @@ void YNV_ECD::begin()
  * @param t_segment t_segment to change t_state
  * @param t_state new t_state of the t_segment: SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
 */
-void YNV_ECD::setSegmentState(int t_segment, bool t_state){
-  m_nextState[t_segment] = t_state;
+void YNV_ECD_BASE::setSegmentState(int t_segment, bool t_state){
+  ecdSegmentMask_t segmentBit = (ecdSegmentMask_t)1 << t_segment;
+
+  m_nextDefinedMask |= segmentBit;
+  if(t_state == SEGMENT_STATE_COLOR){
+    m_nextColorMask |= segmentBit;
+  }
+  else{
+    m_nextColorMask &= ~segmentBit;
+  }
+}
+
+/**
+ * @brief Set the next state of every segment at once
+ * 
+ * Bit i of the frame is the state of segment i: 1 for SEGMENT_STATE_COLOR, 0 for SEGMENT_STATE_BLEACH.
+ * Only the segments that differ from the current state are driven by the next Execute,
+ * phases without segments to change are skipped and an Execute with no changes returns
+ * immediately.
+ * 
+ * @param t_frame segment mask of the new frame
+ */
+void YNV_ECD_BASE::setFrame(ecdSegmentMask_t t_frame){
+  m_nextDefinedMask = m_allSegmentsMask;
+  m_nextColorMask = t_frame & m_allSegmentsMask;
+}
+
+/**
+ * @brief Get the current state of every segment
+ * 
+ * @return segment mask with the segments currently in SEGMENT_STATE_COLOR.
+ * Segments with an undefined state read as bleached.
+ */
+ecdSegmentMask_t YNV_ECD_BASE::getFrame() const{
+  return m_currentDefinedMask & m_currentColorMask;
+}
+
+/**
+ * @brief Check if the next Execute has segments to drive
+ * 
+ * @return true if at least one segment's next state differs from its current state
+ */
+bool YNV_ECD_BASE::hasPendingChanges() const{
+  return (pendingSegments(SEGMENT_STATE_BLEACH) | pendingSegments(SEGMENT_STATE_COLOR)) != 0;
 }
 
 /**
  * Colors and bleaches segments, depending on their state.
  * Change the segments' state with YNV_ECD.setSegmentState() and
  * then call this method to apply the new state.
+ * @note this method blocks until the driving is done. Use YNV_ECD.beginExecute()
+ * and YNV_ECD.update() for non-blocking driving.
 */
-void YNV_ECD::executeDisplay(){
-  bool isDelayRequired = false;
-
-  enableCounterElectrode(m_cfg.bleachingVoltage);
-
-  for (int i = 0; i < m_numberOfSegments; i++)
-  {
-    if(m_stopDrivingFlag == true){
-      return;
-    }
-
-    if(m_nextState[i] != m_currentState[i] && m_nextState[i] == SEGMENT_STATE_BLEACH)
-    {
-      pinMode(m_segmentPinsList[i], OUTPUT);
-      digitalWrite(m_segmentPinsList[i], m_nextState[i]);
-      
-      m_currentState[i] = m_nextState[i];
-      isDelayRequired = true;
-    }
+void YNV_ECD_BASE::executeDisplay(){
+  while(update(ynvHalMillis()) == false){     // A non-blocking operation on-going ends first
+    ynvHalYield();
   }
-  if(isDelayRequired == true){
-    if(m_stopDrivingFlag == true){
-      return;
-    }
-    delay(m_cfg.bleachingTime);
+  beginExecute();
+  while(update(ynvHalMillis()) == false){
+    ynvHalYield();
   }
-  
-  disableAllSegments();
+}
 
-  enableCounterElectrode(m_supplyVoltage - m_cfg.coloringVoltage);
-  isDelayRequired = false;
+/**
+ * Refresh the display. Either after a Display Execute or when the CPU wakes up from sleep.
+ * @note the method will check if a refresh is required and return if it isn't.
+ * @note this method blocks until the refresh is done. Use YNV_ECD.beginRefresh()
+ * and YNV_ECD.update() for non-blocking driving.
+*/
+void YNV_ECD_BASE::refreshDisplay() //Refreshes the display to maintain the current t_state.
+{
+  while(update(ynvHalMillis()) == false){     // A non-blocking operation on-going ends first
+    ynvHalYield();
+  }
+  beginRefresh();
+  while(update(ynvHalMillis()) == false){
+    ynvHalYield();
+  }
+}
 
-  for (int i = 0; i < m_numberOfSegments; i++)
-  {
-    if(m_stopDrivingFlag == true){
-      return;
-    }
-    if(m_nextState[i] != m_currentState[i] && m_nextState[i] == SEGMENT_STATE_COLOR)
-    {
-      pinMode(m_segmentPinsList[i], OUTPUT);
-      digitalWrite(m_segmentPinsList[i], m_nextState[i]);
+/**
+ * @brief Start a non-blocking Execute of the display
+ * 
+ * Runs the same Bleach -> Color -> Refresh sequence as YNV_ECD.executeDisplay(),
+ * but returns immediately. Call YNV_ECD.update() periodically until it returns true.
+ * 
+ * @return handle for YNV_ECD.cancel(), ECD_NO_OPERATION if the display is busy
+ * or nothing had to be driven
+ */
+ecdOperation_t YNV_ECD_BASE::beginExecute(){
+  if(isBusy() || m_stopDrivingFlag == true || hasPendingChanges() == false){
+    return ECD_NO_OPERATION;     // Driving, or nothing changed since the last Execute
+  }
+  discardCommands();
 
-      m_currentState[i] = m_nextState[i];
-      isDelayRequired = true;
-    }
+  if(pendingSegments(SEGMENT_STATE_BLEACH) == 0){
+    startColorPhase(ynvHalMillis());
   }
-  if(isDelayRequired == true){
-    if(m_stopDrivingFlag == true){
-      return;
-    }
-    delay(m_cfg.coloringTime);
+  else{
+    enableCounterElectrode(m_ceBleachCode);
+    enterState(ECD_STATE_BLEACH_SETTLE, ynvHalMillis());
   }
-  disableAllSegments();
-  disableCounterElectrode();
+#if defined(YNV_ECD_STATS)
+  m_stats.executes++;
+#endif
+  return startOperation();
+}
 
-  refreshDisplay();
-  if(m_stopDrivingFlag == true){
-    return;
+/**
+ * @brief Start a non-blocking Refresh of the display
+ * 
+ * Runs the same sequence as YNV_ECD.refreshDisplay(), but returns immediately.
+ * Call YNV_ECD.update() periodically until it returns true.
+ * 
+ * @return handle for YNV_ECD.cancel(), ECD_NO_OPERATION if the display is busy or stopped
+ */
+ecdOperation_t YNV_ECD_BASE::beginRefresh(){
+  if(isBusy() || m_stopDrivingFlag == true){
+    return ECD_NO_OPERATION;
   }
+  discardCommands();
+
+  startRefreshPhase(ynvHalMillis());
+  return startOperation();
 }
 
 /**
- * Refresh the display. Either after a Display Execute or when the CPU wakes up from sleep.
- * @note the method will check if a refresh is required and return if it isn't.
-*/
-void YNV_ECD::refreshDisplay() //Refreshes the display to maintain the current t_state.
-{
-  int analog_val = 0;
-  bool refresh_color_needed = false, refresh_bleach_needed = false;
-  float counterElecVal = 0;
-  float currentLimit = 0;
-  int retries = 0;
-
-  if(m_stopDrivingFlag == true){
-    return;
+ * @brief Cancel a non-blocking operation
+ * 
+ * Only this display is affected, and only if t_operation is the one running:
+ * a stale handle never cancels a newer Execute or Refresh.
+ * The segments and the Counter Electrode are left in High-Impedance.
+ * @note call it from the main loop. From an ISR use YNV_ECD.setCommandQueue().
+ * 
+ * @param t_operation handle returned by YNV_ECD.beginExecute() or YNV_ECD.beginRefresh()
+ * @return true if the operation was running and is now stopped
+ */
+bool YNV_ECD_BASE::cancel(ecdOperation_t t_operation){
+  if(isOperationDone(t_operation)){
+    return false;
   }
+  finishDriving();
+  return true;
+}
 
-  enableCounterElectrode(m_supplyVoltage / 2);
-  disableAllSegments(); // Put all pins in Input mode
+/**
+ * @brief Check if an operation finished, was canceled or was replaced by a newer one
+ */
+bool YNV_ECD_BASE::isOperationDone(ecdOperation_t t_operation) const{
+  return t_operation == ECD_NO_OPERATION || t_operation != m_operation || isBusy() == false;
+}
 
-  for (int i = 0; i < m_numberOfSegments; i++) {
-    if(m_stopDrivingFlag == true){
-      return;
+/**
+ * @brief Advance the non-blocking driving of the display
+ * 
+ * Moves through the driving phases without blocking. Call it as often as possible
+ * (e.g. on every loop()) after YNV_ECD.beginExecute() or YNV_ECD.beginRefresh().
+ * 
+ * @param t_now current time in ms, usually millis()
+ * @return true if the display is idle (driving done or stopped), false otherwise
+ */
+bool YNV_ECD_BASE::update(unsigned long t_now){
+  while(m_driveState != ECD_STATE_IDLE){
+    if(m_stopDrivingFlag == true || processCommands() == true){
+      finishDriving();
+      return true;
     }
-    pinMode(m_segmentPinsList[i], INPUT);
-    analog_val = analogRead(m_segmentPinsList[i]);
 
-    if (m_currentState[i] == SEGMENT_STATE_COLOR && (analog_val < m_refreshColorLimitL)) {
-      m_refreshSegmentNeeded[i] = true;
-      refresh_color_needed = true;
-    } 
-    else if (m_currentState[i] == SEGMENT_STATE_BLEACH && (analog_val > m_refreshBleachLimitH)) {
-      m_refreshSegmentNeeded[i] = true;
-      refresh_bleach_needed = true;
-    }
-  }
+    unsigned long elapsed = t_now - m_stateStartTime;
 
-  if(m_stopDrivingFlag == true){
-    return;
-    }
+    switch(m_driveState){
+      case ECD_STATE_BLEACH_SETTLE:
+        if(elapsed < COUNTER_ELECTRODE_SETTLE_TIME){
+          return false;
+        }
+        if(driveChangedSegments(SEGMENT_STATE_BLEACH) == true){
+          enterState(ECD_STATE_BLEACH_PULSE, t_now);
+        }
+        else{
+          startColorPhase(t_now);
+        }
+      break;
 
-  if ((refresh_bleach_needed || refresh_color_needed) == false) {
-    return; // Return if Refresh isn't needed.
-  }
+      case ECD_STATE_BLEACH_PULSE:
+        if(elapsed < pulsePhaseTime() && updateDriveGroups(SEGMENT_STATE_BLEACH, elapsed) == true &&
+           updateChargeBudget(SEGMENT_STATE_BLEACH, elapsed) == true &&
+           updateClosedLoopPulse(SEGMENT_STATE_BLEACH, t_now) == true){
+          return false;
+        }
+        endPulse(SEGMENT_STATE_BLEACH, elapsed);
+        startColorPhase(t_now);
+      break;
 
-  counterElecVal = m_cfg.refreshBleachingVoltage;
-  
-  enableCounterElectrode(counterElecVal);
+      case ECD_STATE_COLOR_SETTLE:
+        if(elapsed < COUNTER_ELECTRODE_SETTLE_TIME){
+          return false;
+        }
+        if(driveChangedSegments(SEGMENT_STATE_COLOR) == true){
+          enterState(ECD_STATE_COLOR_PULSE, t_now);
+        }
+        else{
+          disableCounterElectrode();
+          startRefreshPhase(t_now);
+        }
+      break;
 
-  while (refresh_bleach_needed) {
-    if(m_stopDrivingFlag == true){
-      return;
-    }
-    
-    for (int i = 0; i < m_numberOfSegments; i++) {
-      if(m_stopDrivingFlag == true){
-        return;
-      }
-      if (m_currentState[i] == SEGMENT_STATE_BLEACH && m_refreshSegmentNeeded[i] == true) {
-        pinMode(m_segmentPinsList[i], OUTPUT);
-        digitalWrite(m_segmentPinsList[i], LOW);
-      }
-    }
-    delay(m_cfg.refreshBleachPulseTime);
-    disableAllSegments();
-    refresh_bleach_needed = false;
+      case ECD_STATE_COLOR_PULSE:
+        if(elapsed < pulsePhaseTime() && updateDriveGroups(SEGMENT_STATE_COLOR, elapsed) == true &&
+           updateChargeBudget(SEGMENT_STATE_COLOR, elapsed) == true &&
+           updateClosedLoopPulse(SEGMENT_STATE_COLOR, t_now) == true){
+          return false;
+        }
+        endPulse(SEGMENT_STATE_COLOR, elapsed);
+        disableAllSegments();
+        disableCounterElectrode();
+        startRefreshPhase(t_now);
+      break;
 
-    if(m_stopDrivingFlag == true){
-      return;
-    }
+      case ECD_STATE_REFRESH_SETTLE:
+        if(elapsed < COUNTER_ELECTRODE_SETTLE_TIME){
+          return false;
+        }
+        disableAllSegments(); // Put all pins in Input mode
+        if (flagRefreshSegments(t_now) == false) {
+          finishDriving(); // Return if Refresh isn't needed.
+          break;
+        }
 
+        startRefreshBleachPhase(t_now);
+      break;
 
-    // Check which Segments still need bleach refresh
-    for (int i = 0; i < m_numberOfSegments; i++) {
-      if(m_stopDrivingFlag == true){
-        return;
-      }
-      if (m_currentState[i] == SEGMENT_STATE_BLEACH && retries < MAX_REFRESH_RETRIES) {
-        pinMode(m_segmentPinsList[i], INPUT);
-        analog_val = analogRead(m_segmentPinsList[i]);
-        if (analog_val > m_refreshBleachLimitL) {
-          m_refreshSegmentNeeded[i] = true;
-          refresh_bleach_needed = true;
+      case ECD_STATE_REFRESH_BLEACH_SETTLE:
+        if(elapsed < COUNTER_ELECTRODE_SETTLE_TIME){
+          return false;
         }
-      }
-    }
-    retries++;
-    delay(500);
-  }
+        driveRefreshSegments(SEGMENT_STATE_BLEACH);
+        enterState(ECD_STATE_REFRESH_BLEACH_PULSE, t_now);
+      break;
+
+      case ECD_STATE_REFRESH_BLEACH_PULSE:
+        if(elapsed < pulsePhaseTime() && updateDriveGroups(SEGMENT_STATE_BLEACH, elapsed) == true &&
+           updateChargeBudget(SEGMENT_STATE_BLEACH, elapsed) == true){
+          return false;
+        }
+        disableAllSegments();
+        endPulse(SEGMENT_STATE_BLEACH, elapsed);
+
+        // Check which Segments still need bleach refresh
+        m_refreshBleachNeeded = checkRefreshSegments(SEGMENT_STATE_BLEACH, m_refreshBleachLimitL);
+        m_refreshRetries++;
+        if(m_refreshBleachNeeded == true){
+          enterState(ECD_STATE_REFRESH_BLEACH_WAIT, t_now);
+        }
+        else{
+          startRefreshColorPhase(t_now);   // Every segment converged, no need to wait
+        }
+      break;
+
+      case ECD_STATE_REFRESH_BLEACH_WAIT:
+        if(elapsed < (unsigned long)m_cfg.refreshRetryInterval){
+          return false;
+        }
+        driveRefreshSegments(SEGMENT_STATE_BLEACH);
+        enterState(ECD_STATE_REFRESH_BLEACH_PULSE, t_now);
+      break;
 
+      case ECD_STATE_REFRESH_COLOR_SETTLE:
+        if(elapsed < COUNTER_ELECTRODE_SETTLE_TIME){
+          return false;
+        }
+        driveRefreshSegments(SEGMENT_STATE_COLOR);
+        enterState(ECD_STATE_REFRESH_COLOR_PULSE, t_now);
+      break;
 
+      case ECD_STATE_REFRESH_COLOR_PULSE:
+        if(elapsed < pulsePhaseTime() && updateDriveGroups(SEGMENT_STATE_COLOR, elapsed) == true &&
+           updateChargeBudget(SEGMENT_STATE_COLOR, elapsed) == true){
+          return false;
+        }
+        disableAllSegments();
+        endPulse(SEGMENT_STATE_COLOR, elapsed);
 
-  counterElecVal = m_supplyVoltage - m_cfg.refreshColoringVoltage;
-  currentLimit = m_refreshColorLimitH;
-  retries = 0;
+        // Check which Segments still need Color refresh
+        m_refreshColorNeeded = checkRefreshSegments(SEGMENT_STATE_COLOR, m_refreshColorLimitH);
+        m_refreshRetries++;
+        if(m_refreshColorNeeded == true){
+          enterState(ECD_STATE_REFRESH_COLOR_WAIT, t_now);
+        }
+        else{
+          finishDriving();   // Every segment converged, no need to wait
+        }
+      break;
 
-  enableCounterElectrode(counterElecVal);
+      case ECD_STATE_REFRESH_COLOR_WAIT:
+        if(elapsed < (unsigned long)m_cfg.refreshRetryInterval){
+          return false;
+        }
+        driveRefreshSegments(SEGMENT_STATE_COLOR);
+        enterState(ECD_STATE_REFRESH_COLOR_PULSE, t_now);
+      break;
 
-  while (refresh_color_needed) {
-    if(m_stopDrivingFlag == true){
-      return;
+      default:
+        finishDriving();
+      break;
     }
+  }
+  return true;
+}
 
-    
-    for (int i = 0; i < m_numberOfSegments; i++) {
-      if(m_stopDrivingFlag == true){
-        return;
-      }
-      if (m_currentState[i] == SEGMENT_STATE_COLOR && m_refreshSegmentNeeded[i] == true) {
-        pinMode(m_segmentPinsList[i], OUTPUT);
-        digitalWrite(m_segmentPinsList[i], HIGH);
-      }
+/**
+ * @brief Predict when the next Refresh is needed
+ * 
+ * Each Refresh check stores the open-circuit voltage of every segment. The decay rate of
+ * each segment is estimated from the samples taken since it was last driven and used to
+ * predict when it will cross its Refresh limit. Segments without enough samples yet are
+ * checked again after ECD_Config.refreshMinInterval.
+ * 
+ * @return millis() at which YNV_ECD.refreshDisplay() should be called next. The host can
+ * sleep until then instead of polling the display.
+ */
+unsigned long YNV_ECD_BASE::nextRefreshDueMs(){
+  if(m_historyValid == false){
+    return ynvHalMillis();      // Never checked, Refresh is due now
+  }
+
+  uint8_t newest = (m_historyHead + REFRESH_HISTORY_DEPTH - 1) % REFRESH_HISTORY_DEPTH;
+  unsigned long lastCheck = m_historyTime[newest];
+  unsigned long dueIn = m_cfg.refreshMaxInterval;
+
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    unsigned long segmentDueIn = m_cfg.refreshMaxInterval;
+
+    bool isColor = (m_currentColorMask >> i) & 1;
+
+    if(((m_currentDefinedMask >> i) & 1) == 0){
+      continue;
     }
 
-    delay(m_cfg.refreshColorPulseTime);
-    if(m_stopDrivingFlag == true){
-      return;
+    if(m_historyCount[i] < 2 || m_historyTime[newest] == m_historyTime[(m_historyHead + REFRESH_HISTORY_DEPTH - m_historyCount[i]) % REFRESH_HISTORY_DEPTH]){
+      segmentDueIn = m_cfg.refreshMinInterval;      // Not enough samples to estimate the decay yet
     }
-    disableAllSegments();
-    refresh_color_needed = false;
+    else{
+      uint8_t oldest = (m_historyHead + REFRESH_HISTORY_DEPTH - m_historyCount[i]) % REFRESH_HISTORY_DEPTH;
+      long lastSample = m_historySamples[i][newest];
+      unsigned long elapsed = m_historyTime[newest] - m_historyTime[oldest];
+      long drift = lastSample - m_historySamples[i][oldest];     // LSB over elapsed
+      long margin = 0;
 
+      // Color segments decay down towards the Color Limit Low, Bleach segments rise towards the Bleach Limit High
+      if(isColor == true){
+        drift = -drift;
+        margin = lastSample - m_refreshColorLimitL;
+      }
+      else{
+        margin = m_refreshBleachLimitH - lastSample;
+      }
 
-    // Check which Segments still need Color refresh
-    for (int i = 0; i < m_numberOfSegments; i++) {
-      if(m_stopDrivingFlag == true){
-        return;
+      if(margin <= 0){
+        segmentDueIn = 0;
       }
-      if (m_currentState[i] == SEGMENT_STATE_COLOR && retries < MAX_REFRESH_RETRIES) {
-        pinMode(m_segmentPinsList[i], INPUT);
-        analog_val = analogRead(m_segmentPinsList[i]);
-        if (analog_val < currentLimit) {
-          m_refreshSegmentNeeded[i] = true;
-          refresh_color_needed = true;
+      else if(drift > 0){
+        // margin * elapsed / drift, split so it can't overflow
+        unsigned long msPerLsb = elapsed / drift;
+        if(msPerLsb < m_cfg.refreshMaxInterval / margin){
+          segmentDueIn = msPerLsb * margin + (elapsed % drift) * margin / drift;
+        }
+        if(segmentDueIn > m_cfg.refreshMaxInterval){
+          segmentDueIn = m_cfg.refreshMaxInterval;
         }
       }
     }
-    retries++;
-    delay(500);
+
+    if(segmentDueIn < m_cfg.refreshMinInterval){
+      segmentDueIn = m_cfg.refreshMinInterval;
+    }
+    if(segmentDueIn < dueIn){
+      dueIn = segmentDueIn;
+    }
   }
 
-  disableCounterElectrode();
+  return lastCheck + dueIn;
+}
+
+/**
+ * @brief Check if the predicted Refresh time was reached
+ * 
+ * @param t_now current time in ms, usually millis()
+ * @return true if YNV_ECD.refreshDisplay() should be called
+ */
+bool YNV_ECD_BASE::isRefreshDue(unsigned long t_now){
+  return (long)(t_now - nextRefreshDueMs()) >= 0;
+}
+
+/**
+ * @brief Get the limits computed for the current config and Supply Voltage
+ * 
+ * @return limits in LSB, to be stored and given back to YNV_ECD.setCalibration()
+ */
+ECD_Limits YNV_ECD_BASE::getLimits() const{
+  ECD_Limits limits;
+
+  limits.refreshColorLimitH   = m_refreshColorLimitH;
+  limits.refreshColorLimitL   = m_refreshColorLimitL;
+  limits.refreshBleachLimitH  = m_refreshBleachLimitH;
+  limits.refreshBleachLimitL  = m_refreshBleachLimitL;
+  limits.colorTargetLimit     = m_colorTargetLimit;
+  limits.bleachTargetLimit    = m_bleachTargetLimit;
+  return limits;
+}
+
+/**
+ * @brief Set a config and the limits stored for it
+ * 
+ * Same as YNV_ECD.setConfig(), but the limits come from a previous YNV_ECD.getLimits()
+ * instead of being computed again.
+ * 
+ * @param t_cfg display config
+ * @param t_limits limits computed for t_cfg at the current Supply Voltage
+ */
+void YNV_ECD_BASE::setCalibration(const ECD_Config& t_cfg, const ECD_Limits& t_limits){
+  m_cfg = t_cfg;
+
+  m_refreshColorLimitH  = t_limits.refreshColorLimitH;
+  m_refreshColorLimitL  = t_limits.refreshColorLimitL;
+  m_refreshBleachLimitH = t_limits.refreshBleachLimitH;
+  m_refreshBleachLimitL = t_limits.refreshBleachLimitL;
+  m_colorTargetLimit    = t_limits.colorTargetLimit;
+  m_bleachTargetLimit   = t_limits.bleachTargetLimit;
+  updateDacCodes();
+  updateChargeScale();
+}
+
+/**
+ * @brief Take the segments' state as known, e.g. from a state saved before power-off
+ * 
+ * Replaces the Color -> Bleach sequence of YNV_ECD.begin() when the display
+ * state is already known.
+ * 
+ * @param t_frame segments in the Color state, the others are taken as bleached
+ */
+void YNV_ECD_BASE::restoreState(ecdSegmentMask_t t_frame){
+  m_currentDefinedMask = m_allSegmentsMask;
+  m_currentColorMask = t_frame & m_allSegmentsMask;
+  m_nextDefinedMask = m_currentDefinedMask;
+  m_nextColorMask = m_currentColorMask;
+  resetHistory(m_allSegmentsMask);
+
+  for(int i = 0; i < m_numberOfSegments; i++){
+    m_segmentCharge[i] = ((m_currentColorMask >> i) & 1) ? ECD_CHARGE_FULL : 0;
+  }
 }
 
 /**
  * Update the Supply Voltage value.
- * @param t_supplyVoltage new supply voltage value
+ * The refresh limits and Counter Electrode DAC codes are computed again.
+ * @param t_supplyVoltage V - new supply voltage value
+ * @note don't call it while the display is driving. YNV_SUPPLY_MONITOR waits for it to be idle.
 */
-void YNV_ECD::updateSupplyVoltage(int t_supplyVoltage){
+void YNV_ECD_BASE::updateSupplyVoltage(float t_supplyVoltage){
   m_supplyVoltage = t_supplyVoltage;
   updateRefreshLimits();
 }
 
+/**
+ * @brief Get the estimated state of charge of a segment
+ * 
+ * Each segment's charge is tracked from the time it's driven and corrected every time
+ * it's sampled in High-Impedance. A segment at ECD_CHARGE_FULL reads the Refresh Color
+ * target, a segment at 0 reads the Refresh Bleach target.
+ * With ECD_Config.chargeBudgetDrive, the pulses of each segment are sized from this estimate.
+ * 
+ * @param t_segment segment index
+ * @return 0 (bleached) - ECD_CHARGE_FULL (colored), 0 for an invalid segment
+ */
+uint16_t YNV_ECD_BASE::getSegmentCharge(int t_segment) const{
+  if(t_segment < 0 || t_segment >= m_numberOfSegments){
+    return 0;
+  }
+  return m_segmentCharge[t_segment];
+}
+
 /**
  * @brief Set the stopDrivingFlag to true
  * 
  * Use this method to stop the current driving and return
- * to where the displayExecute() method was called
+ * to where the displayExecute() method was called.
+ * Only this display is stopped, other displays keep driving.
  */
-void YNV_ECD::setStopDrivingFlag(){
+void YNV_ECD_BASE::setStopDrivingFlag(){
   m_stopDrivingFlag = true;
 }
 
@@ -297,17 +600,85 @@ void YNV_ECD::setStopDrivingFlag(){
  * 
  * Clear the stopDrivingFlag so that the display can be driven again
  */
-void YNV_ECD::clearStopDriving(){
+void YNV_ECD_BASE::clearStopDriving(){
   m_stopDrivingFlag = false;
 }
 
 /** Set all segments to bleach */
-void YNV_ECD::setAllSegmentsBleach(){
+void YNV_ECD_BASE::setAllSegmentsBleach(){
   for(int i = 0; i < m_numberOfSegments; i++){
     setSegmentState(i, SEGMENT_STATE_BLEACH);
   }
 }
 
+#if defined(YNV_ECD_STATS)
+/**
+ * @brief Get the lowest and highest voltage sampled on a segment
+ * 
+ * @param t_segment segment index
+ * @param t_min [LSB] - lowest sample
+ * @param t_max [LSB] - highest sample
+ * @return false if the segment wasn't sampled yet
+ */
+bool YNV_ECD_BASE::getSampleRange(int t_segment, uint16_t& t_min, uint16_t& t_max) const{
+  if(t_segment < 0 || t_segment >= m_numberOfSegments || m_sampleMin[t_segment] > m_sampleMax[t_segment]){
+    return false;
+  }
+  t_min = m_sampleMin[t_segment];
+  t_max = m_sampleMax[t_segment];
+  return true;
+}
+
+/**
+ * @brief Clear all the statistics of the display
+ */
+void YNV_ECD_BASE::resetStats(){
+  m_stats = ECD_Stats();
+  for(int i = 0; i < m_numberOfSegments; i++){
+    m_sampleMin[i] = 0xFFFF;
+    m_sampleMax[i] = 0;
+  }
+}
+
+/**
+ * @brief Print the statistics of the display, one value per line
+ * 
+ * @param t_output where to print, e.g. Serial
+ */
+void YNV_ECD_BASE::printStats(Print& t_output) const{
+  uint32_t settleTime = m_stats.stateTime[ECD_STATE_BLEACH_SETTLE] + m_stats.stateTime[ECD_STATE_COLOR_SETTLE] +
+                        m_stats.stateTime[ECD_STATE_REFRESH_SETTLE] + m_stats.stateTime[ECD_STATE_REFRESH_BLEACH_SETTLE] +
+                        m_stats.stateTime[ECD_STATE_REFRESH_COLOR_SETTLE];
+
+  t_output.print("executes: ");           t_output.println(m_stats.executes);
+  t_output.print("refreshes: ");          t_output.println(m_stats.refreshes);
+  t_output.print("bleach pulse ms: ");    t_output.println(m_stats.stateTime[ECD_STATE_BLEACH_PULSE]);
+  t_output.print("color pulse ms: ");     t_output.println(m_stats.stateTime[ECD_STATE_COLOR_PULSE]);
+  t_output.print("refresh pulse ms: ");   t_output.println(m_stats.stateTime[ECD_STATE_REFRESH_BLEACH_PULSE] + m_stats.stateTime[ECD_STATE_REFRESH_COLOR_PULSE]);
+  t_output.print("refresh wait ms: ");    t_output.println(m_stats.stateTime[ECD_STATE_REFRESH_BLEACH_WAIT] + m_stats.stateTime[ECD_STATE_REFRESH_COLOR_WAIT]);
+  t_output.print("settle ms: ");          t_output.println(settleTime);
+  t_output.print("segments bleached: ");  t_output.println(m_stats.segmentsBleached);
+  t_output.print("segments colored: ");   t_output.println(m_stats.segmentsColored);
+  t_output.print("refresh pulses: ");     t_output.println(m_stats.refreshPulses);
+  t_output.print("max retries: ");        t_output.print(m_stats.maxRefreshRetries);
+  t_output.print("/");                    t_output.println(MAX_REFRESH_RETRIES);
+  t_output.print("retry cap hits: ");     t_output.println(m_stats.retryCapHits);
+
+  for(int i = 0; i < m_numberOfSegments; i++){
+    uint16_t sampleMin, sampleMax;
+    if(getSampleRange(i, sampleMin, sampleMax) == false){
+      continue;
+    }
+    t_output.print("segment ");
+    t_output.print(i);
+    t_output.print(" min/max: ");
+    t_output.print(sampleMin);
+    t_output.print("/");
+    t_output.println(sampleMax);
+  }
+}
+#endif
+
 /********************* END PUBLIC FUNCTIONS **********************/
 
 
@@ -316,39 +687,859 @@ void YNV_ECD::setAllSegmentsBleach(){
 /**
  * Update the Refresh Limits for driving
  * Call this method whenever a parameter that influences the limits changes. e.g. Supply Voltage or Coloring Voltage.
+ * The limits are kept in LSB, so the refresh checks compare the ADC samples without float math.
  */
-void YNV_ECD::updateRefreshLimits(void){
-  m_refreshColorLimitH = ((m_supplyVoltage - m_cfg.refreshColoringVoltage) + m_cfg.refreshColorLimitHVoltage) * ADC_DAC_MAX_LSB / m_supplyVoltage;
-  m_refreshColorLimitL = (m_supplyVoltage/2 +  m_cfg.refreshColorLimitLVoltage) * ADC_DAC_MAX_LSB / m_supplyVoltage;
+void YNV_ECD_BASE::updateRefreshLimits(void){
+  m_refreshColorLimitH = voltageToLsb((m_supplyVoltage - m_cfg.refreshColoringVoltage) + m_cfg.refreshColorLimitHVoltage);
+  m_refreshColorLimitL = voltageToLsb(m_supplyVoltage/2 +  m_cfg.refreshColorLimitLVoltage);
+
+  m_refreshBleachLimitH = voltageToLsb(m_supplyVoltage/2 - m_cfg.refreshBleachLimitHVoltage);
+  m_refreshBleachLimitL = voltageToLsb(m_cfg.refreshBleachingVoltage - m_cfg.refreshBleachLimitLVoltage);
 
-  m_refreshBleachLimitH = (m_supplyVoltage/2 - m_cfg.refreshBleachLimitHVoltage) * ADC_DAC_MAX_LSB / m_supplyVoltage;
-  m_refreshBleachLimitL = (m_cfg.refreshBleachingVoltage - m_cfg.refreshBleachLimitLVoltage) * ADC_DAC_MAX_LSB / m_supplyVoltage;
+  m_colorTargetLimit = voltageToLsb((m_supplyVoltage - m_cfg.coloringVoltage) + m_cfg.refreshColorLimitHVoltage);
+  m_bleachTargetLimit = voltageToLsb(m_cfg.bleachingVoltage - m_cfg.refreshBleachLimitLVoltage);
+
+  updateDacCodes();
+  updateChargeScale();
 }
 
 /**
- * @brief Disable all the segments
+ * Update the Counter Electrode DAC codes of each driving phase
+ * Called with updateRefreshLimits(), or when the limits are given by YNV_ECD.setCalibration().
+ */
+void YNV_ECD_BASE::updateDacCodes(void){
+  m_ceBleachCode = voltageToLsb(m_cfg.bleachingVoltage);
+  m_ceColorCode = voltageToLsb(m_supplyVoltage - m_cfg.coloringVoltage);
+  m_ceRefreshCode = voltageToLsb(m_supplyVoltage / 2);
+  m_ceRefreshBleachCode = voltageToLsb(m_cfg.refreshBleachingVoltage);
+  m_ceRefreshColorCode = voltageToLsb(m_supplyVoltage - m_cfg.refreshColoringVoltage);
+}
+
+/**
+ * @brief Convert a voltage to ADC/DAC LSB at the current Supply Voltage
  * 
- * Sets all the segments' pins to High-Impedance
+ * @param t_voltage V
+ * @return LSB, rounded to the nearest code and limited to 0 - ADC_DAC_MAX_LSB
+ */
+uint16_t YNV_ECD_BASE::voltageToLsb(float t_voltage) const{
+  float lsb = t_voltage * ADC_DAC_MAX_LSB / m_supplyVoltage + 0.5f;
+
+  if(lsb <= 0){
+    return 0;
+  }
+  if(lsb >= ADC_DAC_MAX_LSB){
+    return ADC_DAC_MAX_LSB;
+  }
+  return (uint16_t)lsb;
+}
+
+/**
+ * Update the scale used to convert samples to charge, and the first guess of the Refresh pulse rates
+ * A segment is taken as fully bleached at the Refresh Bleach target and fully colored at the Refresh
+ * Color target. The Refresh pulses are assumed to move charge slower than the Color and Bleach pulses
+ * by the ratio of their voltages, until learnRefreshRate() measures them.
+ */
+void YNV_ECD_BASE::updateChargeScale(void){
+  m_chargeEmptyOffset = voltageToLsb(m_cfg.refreshBleachLimitLVoltage);
+  m_chargeSpan = voltageToLsb(m_cfg.refreshColorLimitHVoltage + m_cfg.refreshBleachLimitLVoltage);
+  if(m_chargeSpan == 0){
+    m_chargeSpan = 1;
+  }
+
+  m_refreshColorFullTime = (unsigned long)(m_cfg.coloringTime * m_cfg.coloringVoltage / m_cfg.refreshColoringVoltage);
+  m_refreshBleachFullTime = (unsigned long)(m_cfg.bleachingTime * m_cfg.bleachingVoltage / m_cfg.refreshBleachingVoltage);
+  if(m_refreshColorFullTime == 0){
+    m_refreshColorFullTime = 1;
+  }
+  if(m_refreshBleachFullTime == 0){
+    m_refreshBleachFullTime = 1;
+  }
+}
+
+/**
+ * @brief Change the state of the non-blocking driving
  * 
- * @note this is not the same as bleaching all the segments
+ * @param t_state new state
+ * @param t_now ms - time at which the new state starts
  */
-void YNV_ECD::disableAllSegments(){ //Put all work electrodes in High-Z mode.
-  for (int i = 0; i < m_numberOfSegments; i++)
-  {
-    pinMode(m_segmentPinsList[i], INPUT);
+void YNV_ECD_BASE::enterState(ecdDriveState_e t_state, unsigned long t_now){
+#if defined(YNV_ECD_STATS)
+  m_stats.stateTime[m_driveState] += t_now - m_stateStartTime;
+#endif
+  m_driveState = t_state;
+  m_stateStartTime = t_now;
+  m_sliceStartTime = t_now;
+}
+
+/**
+ * @brief End the Bleach phase and start the Color phase
+ */
+void YNV_ECD_BASE::startColorPhase(unsigned long t_now){
+  disableAllSegments();
+  if(pendingSegments(SEGMENT_STATE_COLOR) == 0){
+    disableCounterElectrode();
+    startRefreshPhase(t_now);     // Skip the Color phase and its settling time
+    return;
+  }
+  enableCounterElectrode(m_ceColorCode);
+  enterState(ECD_STATE_COLOR_SETTLE, t_now);
+}
+
+/**
+ * @brief Start the Refresh check by biasing the Counter Electrode to half the supply
+ */
+void YNV_ECD_BASE::startRefreshPhase(unsigned long t_now){
+#if defined(YNV_ECD_STATS)
+  m_stats.refreshes++;
+#endif
+  enableCounterElectrode(m_ceRefreshCode);
+  enterState(ECD_STATE_REFRESH_SETTLE, t_now);
+}
+
+/**
+ * @brief Start the Bleach refresh, or the Color refresh if no segment needs bleaching
+ */
+void YNV_ECD_BASE::startRefreshBleachPhase(unsigned long t_now){
+  if(m_refreshBleachNeeded == false){
+    startRefreshColorPhase(t_now);    // Skip the Bleach refresh and its settling time
+    return;
+  }
+  enableCounterElectrode(m_ceRefreshBleachCode);
+  enterState(ECD_STATE_REFRESH_BLEACH_SETTLE, t_now);
+}
+
+/**
+ * @brief End the Bleach refresh and start the Color refresh, if a segment needs coloring
+ */
+void YNV_ECD_BASE::startRefreshColorPhase(unsigned long t_now){
+  m_refreshRetries = 0;
+  if(m_refreshColorNeeded == false){
+    finishDriving();                  // Skip the Color refresh and its settling time
+    return;
+  }
+  enableCounterElectrode(m_ceRefreshColorCode);
+  enterState(ECD_STATE_REFRESH_COLOR_SETTLE, t_now);
+}
+
+/**
+ * @brief Release all pins and return to idle
+ * 
+ * Called when the driving ends or is stopped with YNV_ECD.setStopDrivingFlag()
+ */
+void YNV_ECD_BASE::finishDriving(){
+#if defined(YNV_ECD_STATS)
+  if(m_driveState != ECD_STATE_IDLE){
+    m_stats.stateTime[m_driveState] += ynvHalMillis() - m_stateStartTime;
+  }
+#endif
+  disableAllSegments();
+  disableCounterElectrode();
+  m_driveState = ECD_STATE_IDLE;
+}
+
+/**
+ * @brief Give a new handle to the operation just started
+ */
+ecdOperation_t YNV_ECD_BASE::startOperation(){
+  m_operation++;
+  if(m_operation == ECD_NO_OPERATION){
+    m_operation++;
+  }
+  return m_operation;
+}
+
+/**
+ * @brief Read the commands queued with YNV_ECD.setCommandQueue()
+ * 
+ * Called at every cancellation point of YNV_ECD.update(), so a command from an ISR
+ * takes effect within one state machine step, without waiting for the pulse to end.
+ * When several commands are queued, the last one wins.
+ * 
+ * @return true if the driving must stop
+ */
+bool YNV_ECD_BASE::processCommands(){
+  ecdCommand_e command;
+
+  if(readCommands(command) == false){
+    return false;
+  }
+
+  if(command == ECD_COMMAND_CLEAR){
+    finishDriving();
+    setAllSegmentsBleach();
+    beginExecute();           // Replaces the current driving
+    return m_driveState == ECD_STATE_IDLE;
+  }
+  return true;
+}
+
+/**
+ * @brief Empty the command queue
+ * 
+ * @param t_command last command read, the one that wins
+ * @return false if no command was queued
+ */
+bool YNV_ECD_BASE::readCommands(ecdCommand_e & t_command){
+  uint8_t command;
+  bool found = false;
+
+  if(m_commandQueue == nullptr){
+    return false;
+  }
+
+  while(m_commandQueue->pop(command)){
+    t_command = (ecdCommand_e)command;
+    found = true;
+  }
+  return found;
+}
+
+/**
+ * @brief Drop the commands queued while the display was idle
+ * 
+ * Commands are only read while driving, and apply to the driving they were sent to.
+ * Called when an operation starts from idle, so a STOP or CLEAR left over from
+ * a finished operation doesn't abort the next, unrelated one.
+ */
+void YNV_ECD_BASE::discardCommands(){
+  if(m_commandQueue != nullptr){
+    m_commandQueue->clear();
+  }
+}
+
+/**
+ * @brief Get the segments currently in a given state
+ * 
+ * @param t_state SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ * @return mask of the segments in that state. Segments with an undefined state are never included
+ */
+ecdSegmentMask_t YNV_ECD_BASE::segmentsInState(ecdSegmentState_e t_state) const{
+  if(t_state == SEGMENT_STATE_COLOR){
+    return m_currentDefinedMask & m_currentColorMask;
+  }
+  return m_currentDefinedMask & ~m_currentColorMask;
+}
+
+/**
+ * @brief Get the segments that the next Execute changes to a given state
+ * 
+ * @param t_state SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ * @return mask of the segments whose next state is t_state and differs from the current state
+ */
+ecdSegmentMask_t YNV_ECD_BASE::pendingSegments(ecdSegmentState_e t_state) const{
+  ecdSegmentMask_t nextInState = (t_state == SEGMENT_STATE_COLOR) ? m_nextColorMask : ~m_nextColorMask;
+
+  return m_nextDefinedMask & nextInState & ~segmentsInState(t_state) & m_allSegmentsMask;
+}
+
+/**
+ * @brief Drive the segments that change to a given state
+ * 
+ * @param t_state state being applied: SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ * @return true if at least one segment is being driven
+ */
+bool YNV_ECD_BASE::driveChangedSegments(ecdSegmentState_e t_state){
+  ecdSegmentMask_t segments = pendingSegments(t_state);
+
+  m_pulseMask = 0;
+  m_pulseWaitingMask = 0;
+  if(segments == 0){
+    return false;
+  }
+
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    if (((segments & ~m_currentDefinedMask) >> i) & 1) {
+      m_segmentCharge[i] = (t_state == SEGMENT_STATE_COLOR) ? 0 : ECD_CHARGE_FULL;     // Unknown state, budget a full switch
+    }
+  }
+  m_pulseFullTime = (t_state == SEGMENT_STATE_COLOR) ? m_cfg.coloringTime : m_cfg.bleachingTime;
+  if(m_pulseFullTime == 0){
+    m_pulseFullTime = 1;
+  }
+  m_pulseTime = m_pulseFullTime;
+  m_pulseMargin = 0;
+
+  startPulse(segments, t_state);
+#if defined(YNV_ECD_STATS)
+  if(t_state == SEGMENT_STATE_COLOR){
+    m_stats.segmentsColored += __builtin_popcount(segments);
+  }
+  else{
+    m_stats.segmentsBleached += __builtin_popcount(segments);
+  }
+#endif
+
+  m_currentDefinedMask |= segments;
+  if(t_state == SEGMENT_STATE_COLOR){
+    m_currentColorMask |= segments;
+  }
+  else{
+    m_currentColorMask &= ~segments;
+  }
+  resetHistory(segments);
+  return true;
+}
+
+/**
+ * @brief Closed-loop control of a Color or Bleach pulse
+ * 
+ * When ECD_Config.closedLoopDrive is enabled, the pulse is split in slices of
+ * ECD_Config.closedLoopSliceTime. At the end of each slice the driven segments are
+ * released and sampled, and each one stops being driven once it reaches its target.
+ * 
+ * @param t_state state being applied: SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ * @param t_now ms - current time
+ * @return true if the pulse must go on, false if every segment reached its target
+ */
+bool YNV_ECD_BASE::updateClosedLoopPulse(ecdSegmentState_e t_state, unsigned long t_now){
+  if(m_cfg.closedLoopDrive == false || (t_now - m_sliceStartTime) < (unsigned long)m_cfg.closedLoopSliceTime){
+    return true;
+  }
+  m_sliceStartTime = t_now;
+
+  disableSegments(m_pulseMask);
+  sampleSegments();
+
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    ecdSegmentMask_t segmentBit = (ecdSegmentMask_t)1 << i;
+
+    if((m_pulseMask & segmentBit) == 0){
+      continue;
+    }
+    if((t_state == SEGMENT_STATE_COLOR && m_segmentSamples[i] >= m_colorTargetLimit) ||
+       (t_state == SEGMENT_STATE_BLEACH && m_segmentSamples[i] <= m_bleachTargetLimit)){
+      m_pulseMask &= ~segmentBit;       // Target reached, stop driving this segment
+      m_segmentCharge[i] = (t_state == SEGMENT_STATE_COLOR) ? ECD_CHARGE_FULL : 0;
+    }
+  }
+
+  driveSegments(m_pulseMask, t_state);
+  return (m_pulseMask | m_pulseWaitingMask) != 0;
+}
+
+/**
+ * @brief Drive the segments in a given state which are flagged for refresh
+ * 
+ * @param t_state state being refreshed: SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ */
+void YNV_ECD_BASE::driveRefreshSegments(ecdSegmentState_e t_state){
+  ecdSegmentMask_t segments = segmentsInState(t_state) & m_refreshNeededMask;
+
+  m_pulseFullTime = (t_state == SEGMENT_STATE_COLOR) ? m_refreshColorFullTime : m_refreshBleachFullTime;
+  m_pulseTime = (t_state == SEGMENT_STATE_COLOR) ? m_cfg.refreshColorPulseTime : m_cfg.refreshBleachPulseTime;
+  m_pulseChargeStart = 0;
+  m_pulseMargin = CHARGE_BUDGET_REFRESH_MARGIN;     // Aim past the Refresh limit, so the next check passes
+
+  if(m_cfg.chargeBudgetDrive == true){
+    // One pulse long enough for the segment that needs the most charge, up to a Color or Bleach pulse
+    unsigned long maxPulseTime = (t_state == SEGMENT_STATE_COLOR) ? m_cfg.coloringTime : m_cfg.bleachingTime;
+    m_pulseTime = 0;
+    for (int i = 0; i < m_numberOfSegments; i++) {
+      if (((segments >> i) & 1) && chargeBudgetTime(i, t_state) > m_pulseTime) {
+        m_pulseTime = chargeBudgetTime(i, t_state);
+      }
+    }
+    if(m_pulseTime > maxPulseTime){
+      m_pulseTime = maxPulseTime;
+    }
+  }
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    if ((segments >> i) & 1) {
+      m_pulseChargeStart += m_segmentCharge[i];
+    }
+  }
+
+  startPulse(segments, t_state);
+  resetHistory(segments);
+#if defined(YNV_ECD_STATS)
+  m_stats.refreshPulses++;
+  if(m_refreshRetries > m_stats.maxRefreshRetries){
+    m_stats.maxRefreshRetries = m_refreshRetries;     // The first pulse of a phase isn't a retry
+  }
+#endif
+}
+
+/**
+ * @brief Check which segments in a given state still need a refresh pulse
+ * 
+ * Each segment flagged for refresh drops out of the pulse set as soon as it passes its limit.
+ * Segments still flagged after MAX_REFRESH_RETRIES are dropped as well.
+ * 
+ * @param t_state state being refreshed: SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ * @param t_limit [LSB] - Color segments below or Bleach segments above this limit need refresh
+ * @return true if at least one segment still needs refresh
+ */
+bool YNV_ECD_BASE::checkRefreshSegments(ecdSegmentState_e t_state, uint16_t t_limit){
+  ecdSegmentMask_t segments = segmentsInState(t_state) & m_refreshNeededMask;
+
+  if(m_refreshRetries >= MAX_REFRESH_RETRIES){
+#if defined(YNV_ECD_STATS)
+    m_stats.retryCapHits += __builtin_popcount(segments);
+#endif
+    m_refreshNeededMask &= ~segments;
+    return false;
+  }
+
+  sampleSegments();
+  learnRefreshRate(t_state, segments);
+
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    ecdSegmentMask_t segmentBit = (ecdSegmentMask_t)1 << i;
+
+    if ((segments & segmentBit) == 0) {
+      continue;
+    }
+    if (!((t_state == SEGMENT_STATE_COLOR && m_segmentSamples[i] < t_limit) ||
+          (t_state == SEGMENT_STATE_BLEACH && m_segmentSamples[i] > t_limit))) {
+      m_refreshNeededMask &= ~segmentBit;
+    }
+  }
+  return (segmentsInState(t_state) & m_refreshNeededMask) != 0;
+}
+
+/**
+ * @brief Sample every segment and flag the ones past their Refresh limit
+ * 
+ * The segments must be in High-Impedance, with the Counter Electrode settled at half the supply.
+ * 
+ * @param t_now ms - time of the samples, for the Refresh history
+ * @return true if at least one segment needs a Bleach or Color refresh
+ */
+bool YNV_ECD_BASE::flagRefreshSegments(unsigned long t_now){
+  sampleSegments();
+  recordRefreshHistory(t_now);
+  estimateCharge(m_currentDefinedMask, m_ceRefreshCode);
+  m_refreshBleachNeeded = false;
+  m_refreshColorNeeded = false;
+  m_refreshNeededMask = 0;
+  m_refreshRetries = 0;
+
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    ecdSegmentMask_t segmentBit = (ecdSegmentMask_t)1 << i;
+
+    if ((m_currentDefinedMask & segmentBit) == 0) {
+      continue;
+    }
+    if ((m_currentColorMask & segmentBit) && (m_segmentSamples[i] < m_refreshColorLimitL)) {
+      m_refreshNeededMask |= segmentBit;
+      m_refreshColorNeeded = true;
+    } 
+    else if (!(m_currentColorMask & segmentBit) && (m_segmentSamples[i] > m_refreshBleachLimitH)) {
+      m_refreshNeededMask |= segmentBit;
+      m_refreshBleachNeeded = true;
+    }
+  }
+  return m_refreshBleachNeeded || m_refreshColorNeeded;
+}
+
+/**
+ * @brief Start a pulse on a set of segments, split in staggered drive groups
+ * 
+ * The segments are dealt in turn to ECD_Config.driveGroups groups, so each group holds
+ * segments spread across the display. Only the first group is driven now, the others start
+ * ECD_Config.driveGroupStagger apart from updateDriveGroups(). Each group is driven for
+ * m_pulseTime, so the pulse peak current is split between the groups while the whole pulse
+ * only grows by the stagger times.
+ * 
+ * @param t_segments mask of the segments to drive. m_pulseTime must already be set
+ * @param t_state state being applied: SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ */
+void YNV_ECD_BASE::startPulse(ecdSegmentMask_t t_segments, ecdSegmentState_e t_state){
+  int groups = m_cfg.driveGroups;
+  int count = __builtin_popcount(t_segments);
+  int rank = 0;
+
+  if(groups > ECD_MAX_DRIVE_GROUPS){
+    groups = ECD_MAX_DRIVE_GROUPS;
+  }
+  if(groups > count){
+    groups = count;     // No empty groups, they'd only make the pulse longer
+  }
+  if(groups < 1){
+    groups = 1;
+  }
+
+  for (int g = 0; g < ECD_MAX_DRIVE_GROUPS; g++) {
+    m_driveGroupMask[g] = 0;
+  }
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    if ((t_segments >> i) & 1) {
+      m_driveGroupMask[rank % groups] |= (ecdSegmentMask_t)1 << i;
+      rank++;
+    }
+  }
+  m_driveGroupCount = groups;
+
+  m_pulseMask = m_driveGroupMask[0];
+  m_pulseWaitingMask = t_segments & ~m_pulseMask;
+  driveSegments(m_pulseMask, t_state);
+}
+
+/**
+ * @brief Start and end the drive groups of the current pulse
+ * 
+ * @param t_state state being applied: SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ * @param t_elapsed ms - time since the pulse started
+ * @return true if the pulse must go on, false if every group is done
+ */
+bool YNV_ECD_BASE::updateDriveGroups(ecdSegmentState_e t_state, unsigned long t_elapsed){
+  ecdSegmentMask_t started = 0;
+  ecdSegmentMask_t released = 0;
+
+  for (int g = 0; g < m_driveGroupCount; g++) {
+    unsigned long offset = (unsigned long)g * m_cfg.driveGroupStagger;
+
+    if (t_elapsed >= offset) {
+      started |= m_driveGroupMask[g] & m_pulseWaitingMask;
+    }
+    if (t_elapsed >= offset + m_pulseTime) {
+      released |= m_driveGroupMask[g] & m_pulseMask;
+    }
+  }
+
+  if(released != 0){
+    for (int i = 0; i < m_numberOfSegments; i++) {
+      if ((released >> i) & 1) {
+        addCharge(i, t_state, m_pulseTime);
+      }
+    }
+    disableSegments(released);
+    m_pulseMask &= ~released;
+  }
+  if(started != 0){
+    m_pulseWaitingMask &= ~started;
+    m_pulseMask |= started;
+    driveSegments(started, t_state);
+  }
+  return (m_pulseMask | m_pulseWaitingMask) != 0;
+}
+
+/**
+ * @brief Total length of the current pulse, from the first group start to the last group end
+ */
+unsigned long YNV_ECD_BASE::pulsePhaseTime() const{
+  return m_pulseTime + (unsigned long)(m_driveGroupCount - 1) * m_cfg.driveGroupStagger;
+}
+
+/**
+ * @brief Time a segment of the current pulse has been driven
+ * 
+ * @param t_segment segment index
+ * @param t_elapsed ms - time since the pulse started
+ * @return ms - from the start of the segment's drive group, up to m_pulseTime
+ */
+unsigned long YNV_ECD_BASE::segmentDriveTime(int t_segment, unsigned long t_elapsed) const{
+  unsigned long offset = 0;
+
+  for (int g = 0; g < m_driveGroupCount; g++) {
+    if ((m_driveGroupMask[g] >> t_segment) & 1) {
+      offset = (unsigned long)g * m_cfg.driveGroupStagger;
+      break;
+    }
+  }
+  if(t_elapsed <= offset){
+    return 0;
+  }
+  return (t_elapsed - offset > m_pulseTime) ? m_pulseTime : t_elapsed - offset;
+}
+
+/**
+ * @brief Move the estimated charge of a driven segment
+ * 
+ * @param t_segment segment index
+ * @param t_state state being applied: SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ * @param t_time ms - time the segment was driven in the current pulse
+ */
+void YNV_ECD_BASE::addCharge(int t_segment, ecdSegmentState_e t_state, unsigned long t_time){
+  unsigned long moved = t_time * ECD_CHARGE_FULL / m_pulseFullTime;
+  uint16_t charge = m_segmentCharge[t_segment];
+
+  if(t_state == SEGMENT_STATE_COLOR){
+    m_segmentCharge[t_segment] = (moved >= (unsigned long)(ECD_CHARGE_FULL - charge)) ? ECD_CHARGE_FULL : charge + moved;
+  }
+  else{
+    m_segmentCharge[t_segment] = (moved >= charge) ? 0 : charge - moved;
+  }
+}
+
+/**
+ * @brief Time a segment must be driven in the current pulse to reach its target
+ * 
+ * @param t_segment segment index
+ * @param t_state state being applied: SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ * Refresh pulses aim CHARGE_BUDGET_REFRESH_MARGIN past the target.
+ * 
+ * @return ms - at least CHARGE_BUDGET_MIN_PULSE_TIME
+ */
+unsigned long YNV_ECD_BASE::chargeBudgetTime(int t_segment, ecdSegmentState_e t_state) const{
+  unsigned long needed = (t_state == SEGMENT_STATE_COLOR) ? ECD_CHARGE_FULL - m_segmentCharge[t_segment] : m_segmentCharge[t_segment];
+  unsigned long budget = (needed + m_pulseMargin) * m_pulseFullTime / ECD_CHARGE_FULL;
+
+  return (budget < CHARGE_BUDGET_MIN_PULSE_TIME) ? CHARGE_BUDGET_MIN_PULSE_TIME : budget;
+}
+
+/**
+ * @brief Release the segments of the current pulse whose charge budget is spent
+ * 
+ * Only used with ECD_Config.chargeBudgetDrive. Each segment is driven for the time it needs
+ * to move from its estimated charge to its target, see chargeBudgetTime().
+ * 
+ * @param t_state state being applied: SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ * @param t_elapsed ms - time since the pulse started
+ * @return true if the pulse must go on, false if every segment spent its budget or is done
+ */
+bool YNV_ECD_BASE::updateChargeBudget(ecdSegmentState_e t_state, unsigned long t_elapsed){
+  ecdSegmentMask_t released = 0;
+
+  if(m_cfg.chargeBudgetDrive == false){
+    return true;
+  }
+
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    if (((m_pulseMask >> i) & 1) && segmentDriveTime(i, t_elapsed) >= chargeBudgetTime(i, t_state)) {
+      addCharge(i, t_state, segmentDriveTime(i, t_elapsed));
+      released |= (ecdSegmentMask_t)1 << i;
+    }
+  }
+  if(released != 0){
+    disableSegments(released);
+    m_pulseMask &= ~released;
+  }
+  return (m_pulseMask | m_pulseWaitingMask) != 0;
+}
+
+/**
+ * @brief Account the charge of the segments still driven when a pulse ends
+ * 
+ * @param t_state state being applied: SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ * @param t_elapsed ms - length of the pulse
+ */
+void YNV_ECD_BASE::endPulse(ecdSegmentState_e t_state, unsigned long t_elapsed){
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    if ((m_pulseMask >> i) & 1) {
+      addCharge(i, t_state, segmentDriveTime(i, t_elapsed));
+    }
+  }
+  m_pulseMask = 0;
+  m_pulseWaitingMask = 0;
+}
+
+/**
+ * @brief Replace the estimated charge of a set of segments with their last samples
+ * 
+ * @param t_segments mask of the segments sampled in High-Impedance
+ * @param t_ceCode LSB - Counter Electrode DAC code when they were sampled
+ */
+void YNV_ECD_BASE::estimateCharge(ecdSegmentMask_t t_segments, uint16_t t_ceCode){
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    if (((t_segments >> i) & 1) == 0) {
+      continue;
+    }
+    long level = (long)m_segmentSamples[i] + m_chargeEmptyOffset - t_ceCode;
+
+    if(level <= 0){
+      m_segmentCharge[i] = 0;
+    }
+    else if(level >= m_chargeSpan){
+      m_segmentCharge[i] = ECD_CHARGE_FULL;
+    }
+    else{
+      m_segmentCharge[i] = level * ECD_CHARGE_FULL / m_chargeSpan;
+    }
+  }
+}
+
+/**
+ * @brief Correct the estimated rate of the Refresh pulses from the segments' response
+ * 
+ * Compares the charge that the last Refresh pulse was expected to move with the charge
+ * measured after it, and moves the rate halfway to the measured one.
+ * Also replaces the estimated charge of the refreshed segments with the measured one.
+ * 
+ * @param t_state state being refreshed: SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ * @param t_segments mask of the segments driven by the last Refresh pulse, already sampled
+ */
+void YNV_ECD_BASE::learnRefreshRate(ecdSegmentState_e t_state, ecdSegmentMask_t t_segments){
+  unsigned long * fullTime = (t_state == SEGMENT_STATE_COLOR) ? &m_refreshColorFullTime : &m_refreshBleachFullTime;
+  uint32_t expected = 0;
+  uint32_t measured = 0;
+
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    if ((t_segments >> i) & 1) {
+      expected += m_segmentCharge[i];
+    }
+  }
+  estimateCharge(t_segments, (t_state == SEGMENT_STATE_COLOR) ? m_ceRefreshColorCode : m_ceRefreshBleachCode);
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    if ((t_segments >> i) & 1) {
+      measured += m_segmentCharge[i];
+    }
+  }
+
+  // Charge moved by the pulse, towards the state being refreshed
+  long expectedDelta = (t_state == SEGMENT_STATE_COLOR) ? (long)(expected - m_pulseChargeStart) : (long)(m_pulseChargeStart - expected);
+  long measuredDelta = (t_state == SEGMENT_STATE_COLOR) ? (long)(measured - m_pulseChargeStart) : (long)(m_pulseChargeStart - measured);
+
+  if(expectedDelta <= 0 || measuredDelta < CHARGE_LEARN_MIN_DELTA){
+    return;     // Too little response to tell the rate apart from noise
+  }
+  unsigned long measuredFullTime = *fullTime * expectedDelta / measuredDelta;
+  unsigned long maxFullTime = CHARGE_LEARN_MAX_RATIO * ((t_state == SEGMENT_STATE_COLOR) ? m_cfg.coloringTime : m_cfg.bleachingTime);
+
+  if(measuredFullTime > maxFullTime){
+    measuredFullTime = maxFullTime;
+  }
+  *fullTime = (*fullTime + measuredFullTime + 1) / 2;
+}
+
+/**
+ * @brief Sample the voltage of all the segments
+ * 
+ * Samples the whole segment pin list in one pass and stores the results
+ * in m_segmentSamples, which the refresh checks read from.
+ * @note the segments must be in High-Impedance when sampling
+ */
+void YNV_ECD_BASE::sampleSegments(){
+  ynvAnalogScan(m_segmentPinsList, m_numberOfSegments, m_segmentSamples);
+#if defined(YNV_ECD_STATS)
+  for(int i = 0; i < m_numberOfSegments; i++){
+    if(m_segmentSamples[i] < m_sampleMin[i]){
+      m_sampleMin[i] = m_segmentSamples[i];
+    }
+    if(m_segmentSamples[i] > m_sampleMax[i]){
+      m_sampleMax[i] = m_segmentSamples[i];
+    }
+  }
+#endif
+}
+
+/**
+ * @brief Store the last Refresh check samples in the history
+ * 
+ * @param t_now ms - time of the Refresh check
+ */
+void YNV_ECD_BASE::recordRefreshHistory(unsigned long t_now){
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    m_historySamples[i][m_historyHead] = m_segmentSamples[i];
+    if(m_historyCount[i] < REFRESH_HISTORY_DEPTH){
+      m_historyCount[i]++;
+    }
+  }
+  m_historyTime[m_historyHead] = t_now;
+  m_historyHead = (m_historyHead + 1) % REFRESH_HISTORY_DEPTH;
+  m_historyValid = true;
+}
+
+/**
+ * @brief Restart the history of driven segments
+ * 
+ * @param t_segments mask of the segments that were driven
+ */
+void YNV_ECD_BASE::resetHistory(ecdSegmentMask_t t_segments){
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    if ((t_segments >> i) & 1) {
+      m_historyCount[i] = 0;
+    }
+  }
+}
+
+/**
+ * @brief Drive a set of segments
+ * 
+ * On SAMD21 every segment in the set is switched with one OUT and one DIR
+ * register write per PORT group, so all of them start at the same time.
+ * 
+ * @param t_segments mask of the segments to drive
+ * @param t_state SEGMENT_STATE_COLOR drives the segments HIGH, SEGMENT_STATE_BLEACH drives them LOW
+ */
+void YNV_ECD_BASE::driveSegments(ecdSegmentMask_t t_segments, ecdSegmentState_e t_state){
+#if defined(YNV_ECD_FAST_GPIO)
+  uint32_t portBits[ECD_GPIO_NUM_PORTS] = {0};
+
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    if ((t_segments >> i) & 1) {
+      portBits[m_segmentPort[i]] |= m_segmentPortBit[i];
+    }
+  }
+  for (int p = 0; p < ECD_GPIO_NUM_PORTS; p++) {
+    if (portBits[p] == 0) {
+      continue;
+    }
+    if (t_state == SEGMENT_STATE_COLOR) {
+      PORT->Group[p].OUTSET.reg = portBits[p];
+    }
+    else {
+      PORT->Group[p].OUTCLR.reg = portBits[p];
+    }
+    PORT->Group[p].DIRSET.reg = portBits[p];
+  }
+#else
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    if ((t_segments >> i) & 1) {
+      ynvHalPinMode(m_segmentPinsList[i], OUTPUT);
+      ynvHalDigitalWrite(m_segmentPinsList[i], t_state == SEGMENT_STATE_COLOR ? HIGH : LOW);
+    }
+  }
+#endif
+}
+
+/**
+ * @brief Set a set of segments to High-Impedance
+ * 
+ * @param t_segments mask of the segments to disable
+ */
+void YNV_ECD_BASE::disableSegments(ecdSegmentMask_t t_segments){
+#if defined(YNV_ECD_FAST_GPIO)
+  uint32_t portBits[ECD_GPIO_NUM_PORTS] = {0};
+
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    if ((t_segments >> i) & 1) {
+      portBits[m_segmentPort[i]] |= m_segmentPortBit[i];
+    }
+  }
+  for (int p = 0; p < ECD_GPIO_NUM_PORTS; p++) {
+    if (portBits[p] != 0) {
+      PORT->Group[p].DIRCLR.reg = portBits[p];
+    }
+  }
+#else
+  for (int i = 0; i < m_numberOfSegments; i++) {
+    if ((t_segments >> i) & 1) {
+      ynvHalPinMode(m_segmentPinsList[i], INPUT);
+    }
+  }
+#endif
+}
+
+/**
+ * @brief Disable all the segments
+ * 
+ * Sets all the segments' pins to High-Impedance
+ * 
+ * @note this is not the same as bleaching all the segments
+ */
+void YNV_ECD_BASE::disableAllSegments(){ //Put all work electrodes in High-Z mode.
+#if defined(YNV_ECD_FAST_GPIO)
+  for (int p = 0; p < ECD_GPIO_NUM_PORTS; p++) {
+    if (m_portAllSegments[p] != 0) {
+      PORT->Group[p].DIRCLR.reg = m_portAllSegments[p];
+    }
   }
+#else
+  disableSegments(m_allSegmentsMask);
+#endif
 }
 
 /**
  * @brief Enable the Counter Electrode's pin
  * 
- * @param t_voltage Voltage with which to drive 
- * the Counter Electrode analog pin.
+ * @param t_dacCode LSB - DAC code with which to drive
+ * the Counter Electrode analog pin. See updateDacCodes()
+ * @note the caller must wait COUNTER_ELECTRODE_SETTLE_TIME before driving segments
  */
-void YNV_ECD::enableCounterElectrode(float t_voltage) //Enable counter electrode
+void YNV_ECD_BASE::enableCounterElectrode(uint16_t t_dacCode) //Enable counter electrode
 {
-  analogWrite(m_counterElectrodePin, int(ADC_DAC_MAX_LSB*(t_voltage/m_supplyVoltage)));
-  delay(50);
+  ynvHalAnalogWrite(m_counterElectrodePin, t_dacCode);
 }
 
 /**
@@ -356,8 +1547,8 @@ void YNV_ECD::enableCounterElectrode(float t_voltage) //Enable counter electrode
  * 
  * Sets the Counter Electrode's pin to High-Impedance
  */
-void YNV_ECD::disableCounterElectrode() //Set counter electrode in High-Z.
+void YNV_ECD_BASE::disableCounterElectrode() //Set counter electrode in High-Z.
 {
-  analogWrite(m_counterElectrodePin, 0);
+  ynvHalAnalogWrite(m_counterElectrodePin, 0);
 }
 /********************* END PRIVATE FUNCTIONS **********************/
\ No newline at end of file
@@ -8,8 +8,21 @@
 #define _YNVISIBLE_ECD
 
 #include "Arduino.h"
+#include "YnvisibleHAL.h"
+#include "YnvisibleADC.h"
+#include "YnvisibleQueue.h"
 
-#define MAX_NUMBER_OF_SEGMENTS 15
+// SAMD21: switch all segments of a phase with port-wide register writes. Needs the register-level ADC scan,
+// which gives the pins back to the PORT after sampling. Define YNV_ECD_NO_FAST_GPIO to disable it.
+#if defined(YNV_ADC_FAST_SCAN) && !defined(YNV_ECD_NO_FAST_GPIO)
+#define YNV_ECD_FAST_GPIO
+#define ECD_GPIO_NUM_PORTS 3			// PORTA, PORTB and PORTC
+#endif
+
+// Keep driving statistics for each display, see YNV_ECD_BASE::getStats(). Define YNV_ECD_STATS in the build flags
+// of both the library and the sketch to enable it. When it's not defined, nothing is compiled in.
+
+#define MAX_NUMBER_OF_SEGMENTS 15				// Segment masks are 32 bits wide, so this can't be above 32
 #define MAX_REFRESH_RETRIES 30
 
 #define SUPPLY_VOLTAGE 3.0				// V - Supply voltage of the board
@@ -32,6 +45,26 @@
 #define REFRESH_COLOR_PULSE_TIME 	100
 #define REFRESH_BLEACH_PULSE_TIME 50
 #define REFRESH_SLEEP_INTERVAL 		10
+#define REFRESH_RETRY_INTERVAL		500			// ms - Wait between each Refresh retry
+
+#define COUNTER_ELECTRODE_SETTLE_TIME	50		// ms - Settling time after changing the Counter Electrode voltage
+
+#define CLOSED_LOOP_SLICE_TIME		50				// ms - Time between voltage checks in closed-loop Color and Bleach pulses
+
+#define ECD_MAX_DRIVE_GROUPS 			4				// Most staggered segment groups in one pulse, see ECD_Config.driveGroups
+#define DRIVE_GROUP_STAGGER_TIME 	50			// ms - Time between the start of two drive groups
+
+#define REFRESH_HISTORY_DEPTH			4				// Number of Refresh check samples kept per segment to estimate its decay
+#define REFRESH_MIN_INTERVAL			10000		// ms - Shortest time between Refresh checks (also used while learning the decay)
+#define REFRESH_MAX_INTERVAL			600000	// ms - Longest time between Refresh checks
+
+#define ECD_COMMAND_QUEUE_SIZE		8				// Slots of an ECD_CommandQueue
+
+#define ECD_CHARGE_FULL 					1000		// Estimated charge of a colored segment, 0 is bleached. See YNV_ECD_BASE::getSegmentCharge()
+#define CHARGE_BUDGET_MIN_PULSE_TIME	10	// ms - Shortest pulse given to a segment by ECD_Config.chargeBudgetDrive
+#define CHARGE_BUDGET_REFRESH_MARGIN	50	// Extra charge given by Refresh pulses, as the response slows down near the target
+#define CHARGE_LEARN_MIN_DELTA 		20			// Least charge moved by a Refresh pulse to correct its estimated rate
+#define CHARGE_LEARN_MAX_RATIO 		8ul			// Longest estimated Refresh switching time, in Color or Bleach pulse times
 
 enum ecdSegmentState_e{
 	SEGMENT_STATE_UNDEFINED = -1,
@@ -39,6 +72,43 @@ enum ecdSegmentState_e{
 	SEGMENT_STATE_COLOR = 1
 };
 
+typedef uint32_t ecdSegmentMask_t;		// One bit per segment, bit 0 is the first segment of the pin list
+
+/**
+ * States of the non-blocking driving state machine.
+ * See YNV_ECD_BASE::beginExecute(), YNV_ECD_BASE::beginRefresh() and YNV_ECD_BASE::update()
+ */
+enum ecdDriveState_e{
+	ECD_STATE_IDLE = 0,
+	ECD_STATE_BLEACH_SETTLE,					// Counter Electrode settling for the Bleach pulse
+	ECD_STATE_BLEACH_PULSE,						// Bleach pulse on-going
+	ECD_STATE_COLOR_SETTLE,						// Counter Electrode settling for the Color pulse
+	ECD_STATE_COLOR_PULSE,						// Color pulse on-going
+	ECD_STATE_REFRESH_SETTLE,					// Counter Electrode settling for the Refresh check
+	ECD_STATE_REFRESH_BLEACH_SETTLE,	// Counter Electrode settling for the Bleach refresh pulses
+	ECD_STATE_REFRESH_BLEACH_PULSE,		// Bleach refresh pulse on-going
+	ECD_STATE_REFRESH_BLEACH_WAIT,		// Wait between Bleach refresh retries
+	ECD_STATE_REFRESH_COLOR_SETTLE,		// Counter Electrode settling for the Color refresh pulses
+	ECD_STATE_REFRESH_COLOR_PULSE,		// Color refresh pulse on-going
+	ECD_STATE_REFRESH_COLOR_WAIT			// Wait between Color refresh retries
+};
+#define ECD_NUM_DRIVE_STATES		(ECD_STATE_REFRESH_COLOR_WAIT + 1)
+
+/**
+ * Commands sent to a driving display, e.g. from a button ISR.
+ * They are read at the cancellation points of YNV_ECD_BASE::update() and YNV_ECD_GROUP::update().
+ * Commands still queued when an Execute or Refresh starts from idle are discarded.
+ */
+enum ecdCommand_e{
+	ECD_COMMAND_STOP = 0,							// Stop driving, leave the segments disabled
+	ECD_COMMAND_CLEAR									// Stop driving and bleach all segments
+};
+
+typedef YNV_SPSC_QUEUE<uint8_t, ECD_COMMAND_QUEUE_SIZE> ECD_CommandQueue;		// Holds ecdCommand_e values
+
+typedef uint16_t ecdOperation_t;		// Handle of a non-blocking Execute or Refresh
+#define ECD_NO_OPERATION 				0		// Returned when nothing was started
+
 struct ECD_Config{
 	//Color & Bleach Configs
 	float 	coloringVoltage 						{ COLORING_VOLTAGE };			// V - Absolute value for Color Pulse Voltage
@@ -58,59 +128,336 @@ struct ECD_Config{
 
 	int 		refreshColorPulseTime				{ REFRESH_COLOR_PULSE_TIME };		// ms - Delay between each Refresh Pulse
 	int			refreshBleachPulseTime			{ REFRESH_BLEACH_PULSE_TIME};
+	int 		refreshRetryInterval				{ REFRESH_RETRY_INTERVAL };			// ms - Wait between each Refresh retry
+
+	//Closed-loop Configs
+	bool 		closedLoopDrive 						{ false };									// Stop driving each segment as soon as it reaches its target voltage
+	int 		closedLoopSliceTime 				{ CLOSED_LOOP_SLICE_TIME };	// ms - Time between voltage checks. coloringTime and bleachingTime are the upper bound
+
+	//Charge budget Configs
+	bool 		chargeBudgetDrive 					{ false };									// Size each segment's pulses to the charge it's estimated to need
+
+	//Drive group Configs - Split the segments of each pulse in interleaved groups with staggered starts, to cap the peak current
+	uint8_t driveGroups 								{ 1 };											// 1 - ECD_MAX_DRIVE_GROUPS. 1 drives all the segments together
+	int 		driveGroupStagger 					{ DRIVE_GROUP_STAGGER_TIME };	// ms - Start delay between groups. Each group is driven for the full pulse time
+
+	unsigned long refreshMinInterval		{ REFRESH_MIN_INTERVAL };				// ms - Shortest interval returned by YNV_ECD_BASE::nextRefreshDueMs()
+	unsigned long refreshMaxInterval		{ REFRESH_MAX_INTERVAL };				// ms - Longest interval returned by YNV_ECD_BASE::nextRefreshDueMs()
+};
+
+/**
+ * Refresh and closed-loop limits of a display, computed from its ECD_Config and Supply Voltage.
+ * See YNV_ECD_BASE::getLimits() and YNV_ECD_BASE::setCalibration()
+ */
+struct ECD_Limits{
+	uint16_t 	refreshColorLimitH;			// LSB
+	uint16_t 	refreshColorLimitL;			// LSB
+	uint16_t 	refreshBleachLimitH;		// LSB
+	uint16_t 	refreshBleachLimitL;		// LSB
+	uint16_t 	colorTargetLimit;				// LSB
+	uint16_t 	bleachTargetLimit;			// LSB
+};
+
+#if defined(YNV_ECD_STATS)
+/**
+ * Driving statistics of a display, since it was created or since YNV_ECD_BASE::resetStats().
+ * The per-segment sample ranges are read with YNV_ECD_BASE::getSampleRange().
+ */
+struct ECD_Stats{
+	uint32_t 	executes;													// Executes started
+	uint32_t 	refreshes;												// Refresh checks, after each Execute and from YNV_ECD.refreshDisplay()
+	uint32_t 	stateTime[ECD_NUM_DRIVE_STATES];	// ms - Time spent in each ecdDriveState_e. The *_SETTLE states are the Counter Electrode settling
+	uint32_t 	segmentsBleached;									// Segments driven by Bleach pulses
+	uint32_t 	segmentsColored;									// Segments driven by Color pulses
+	uint32_t 	refreshPulses;										// Refresh pulses, Bleach and Color
+	uint16_t 	maxRefreshRetries;								// Most retries used by one Refresh phase, out of MAX_REFRESH_RETRIES
+	uint32_t 	retryCapHits;											// Segments dropped after MAX_REFRESH_RETRIES without converging
+};
+#endif
+
+/**
+ * Pointers to the per-segment storage of a display. See ECD_SegmentStorage
+ */
+struct ECD_SegmentBuffers{
+	int * 			pins;
+	uint16_t * 	samples;
+	uint16_t 		(* history)[REFRESH_HISTORY_DEPTH];
+	uint8_t * 	historyCount;
+	uint16_t * 	charge;
+#if defined(YNV_ECD_FAST_GPIO)
+	uint8_t * 	port;
+	uint32_t * 	portBit;
+#endif
+#if defined(YNV_ECD_STATS)
+	uint16_t * 	sampleMin;
+	uint16_t * 	sampleMax;
+#endif
+};
+
+/**
+ * Per-segment storage for a display with t_numberOfSegments segments
+ */
+template<int t_numberOfSegments>
+struct ECD_SegmentStorage{
+	int 			pins[t_numberOfSegments];
+	uint16_t 	samples[t_numberOfSegments];
+	uint16_t 	history[t_numberOfSegments][REFRESH_HISTORY_DEPTH];
+	uint8_t 	historyCount[t_numberOfSegments];
+	uint16_t 	charge[t_numberOfSegments];
+#if defined(YNV_ECD_FAST_GPIO)
+	uint8_t 	port[t_numberOfSegments];
+	uint32_t 	portBit[t_numberOfSegments];
+#endif
+#if defined(YNV_ECD_STATS)
+	uint16_t 	sampleMin[t_numberOfSegments];
+	uint16_t 	sampleMax[t_numberOfSegments];
+#endif
+
+	ECD_SegmentBuffers buffers(){
+		ECD_SegmentBuffers buffers;
+		buffers.pins = pins;
+		buffers.samples = samples;
+		buffers.history = history;
+		buffers.historyCount = historyCount;
+		buffers.charge = charge;
+#if defined(YNV_ECD_FAST_GPIO)
+		buffers.port = port;
+		buffers.portBit = portBit;
+#endif
+#if defined(YNV_ECD_STATS)
+		buffers.sampleMin = sampleMin;
+		buffers.sampleMax = sampleMax;
+#endif
+		return buffers;
+	}
 };
 
-class YNV_ECD
+/**
+ * Ynvisible's Electrochromic Display driver.
+ * 
+ * Holds all the driving logic. The per-segment storage is provided by the derived classes:
+ * YNV_ECD (runtime number of segments, up to MAX_NUMBER_OF_SEGMENTS) and
+ * YNV_ECD_T (number of segments fixed at compile time, storage sized exactly).
+ */
+class YNV_ECD_BASE
 {
+	friend class YNV_ECD_GROUP;
+	friend class YNV_POWER_MANAGER;
+
 	public:
-		YNV_ECD(int t_numberOfSegments, int* t_segments);
 		void begin();
 		void setConfig(const ECD_Config& t_cfg) { m_cfg = t_cfg; updateRefreshLimits(); }
+		const ECD_Config& getConfig() const { return m_cfg; }
+		float getSupplyVoltage() const { return m_supplyVoltage; }
+		ECD_Limits getLimits() const;
+		void setCalibration(const ECD_Config& t_cfg, const ECD_Limits& t_limits);		// Set a stored config and its limits, without recomputing them
+		void restoreState(ecdSegmentMask_t t_frame);												// Take a known segment state instead of begin()
 
 		void setSegmentState(int t_segment, bool t_state);
+		void setFrame(ecdSegmentMask_t t_frame);						// Set the next state of all segments. Bit i = segment i, 1 = Color
+		ecdSegmentMask_t getFrame() const;									// Current state of all segments
+		bool hasPendingChanges() const;
 		void executeDisplay();
 		void refreshDisplay();
 
-		void updateSupplyVoltage(int t_supplyVoltage);
+		ecdOperation_t beginExecute();											// Start a non-blocking Execute (Bleach -> Color -> Refresh)
+		ecdOperation_t beginRefresh();											// Start a non-blocking Refresh
+		bool cancel(ecdOperation_t t_operation);						// Stop an operation of this display, if it's still running
+		bool isOperationDone(ecdOperation_t t_operation) const;
+		bool update(unsigned long t_now);										// Advance the non-blocking driving. Returns true when done
+		bool poll() { return update(ynvHalMillis()); }
+		bool isBusy() const { return m_driveState != ECD_STATE_IDLE; }
+		ecdDriveState_e getDriveState() const { return m_driveState; }
+
+		unsigned long nextRefreshDueMs();										// millis() at which the next Refresh is predicted to be needed
+		bool isRefreshDue(unsigned long t_now);
+
+		void updateSupplyVoltage(float t_supplyVoltage);			// V - Recomputes the limits and DAC codes. See YNV_SUPPLY_MONITOR
+
+		uint16_t getSegmentCharge(int t_segment) const;			// Estimated charge, 0 (bleached) - ECD_CHARGE_FULL (colored)
 		
 		void setStopDrivingFlag();
 		void clearStopDriving();
+		void setCommandQueue(ECD_CommandQueue * t_queue) { m_commandQueue = t_queue; }	// Can be shared by displays that never drive at the same time
 		
 		void setAllSegmentsBleach();
+
+#if defined(YNV_ECD_STATS)
+		ECD_Stats getStats() const { return m_stats; }			// Snapshot of the counters
+		bool getSampleRange(int t_segment, uint16_t& t_min, uint16_t& t_max) const;
+		void resetStats();
+		void printStats(Print& t_output) const;							// e.g. printStats(Serial)
+#endif
 		
 
+	protected:
+		YNV_ECD_BASE() {}
+		YNV_ECD_BASE(const YNV_ECD_BASE&) = delete;						// The segment buffers point into the derived class' storage
+		YNV_ECD_BASE& operator=(const YNV_ECD_BASE&) = delete;
+		void attachSegments(int t_numberOfSegments, const int * t_segments, const ECD_SegmentBuffers& t_buffers);
+
 	private:
 		ECD_Config m_cfg;
 
-		int m_numberOfSegments;
+		int m_numberOfSegments { 0 };
 		
-		uint8_t m_currentState[MAX_NUMBER_OF_SEGMENTS];
-		uint8_t	m_nextState[MAX_NUMBER_OF_SEGMENTS];
+		//SEGMENT STATES - One bit per segment
+		ecdSegmentMask_t m_allSegmentsMask 			{ 0 };
+		ecdSegmentMask_t m_currentDefinedMask 	{ 0 };			// Segments with a known state
+		ecdSegmentMask_t m_currentColorMask 		{ 0 };			// Segments in the Color state
+		ecdSegmentMask_t m_nextDefinedMask 			{ 0 };			// Segments set with setSegmentState()
+		ecdSegmentMask_t m_nextColorMask 				{ 0 };			// Segments to set to the Color state
 		float 	m_supplyVoltage {SUPPLY_VOLTAGE};
 
-		float 	m_refreshColorLimitH 					{ ((SUPPLY_VOLTAGE - REFRESH_COLORING_VOLTAGE) + REFRESH_COLOR_LIMIT_H_REL_AMP) * ADC_DAC_MAX_LSB / SUPPLY_VOLTAGE };		//Refresh Color Limit High [LSB]
-		float 	m_refreshColorLimitL 					{ (SUPPLY_VOLTAGE/2 +  REFRESH_COLOR_LIMIT_L_REL_AMP) * ADC_DAC_MAX_LSB / SUPPLY_VOLTAGE };															//Refresh Color Limit Low [LSB]
-		
-		float 	m_refreshBleachLimitH  				{ (SUPPLY_VOLTAGE/2 - REFRESH_BLEACH_LIMIT_H_REL_AMP) * ADC_DAC_MAX_LSB / SUPPLY_VOLTAGE };															//Refresh Bleach Limit High [LSB]
-		float 	m_refreshBleachLimitL 				{ (REFRESH_BLEACHING_VOLTAGE - REFRESH_BLEACH_LIMIT_L_REL_AMP) * ADC_DAC_MAX_LSB / SUPPLY_VOLTAGE };										//Refresh Bleach Limit Low [LSB]
+		//LIMITS [LSB] - Computed from the config and Supply Voltage by updateRefreshLimits()
+		uint16_t 	m_refreshColorLimitH 					{ 0 };			// Refresh Color Limit High
+		uint16_t 	m_refreshColorLimitL 					{ 0 };			// Refresh Color Limit Low
+		uint16_t 	m_refreshBleachLimitH  				{ 0 };			// Refresh Bleach Limit High
+		uint16_t 	m_refreshBleachLimitL 				{ 0 };			// Refresh Bleach Limit Low
+		uint16_t 	m_colorTargetLimit 						{ 0 };			// Closed-loop Color target
+		uint16_t 	m_bleachTargetLimit 					{ 0 };			// Closed-loop Bleach target
 
-		bool 		m_refreshSegmentNeeded[MAX_NUMBER_OF_SEGMENTS];
+		//COUNTER ELECTRODE DAC CODES [LSB] - Computed with the limits, so driving needs no float math
+		uint16_t 	m_ceBleachCode 								{ 0 };			// Bleach pulses
+		uint16_t 	m_ceColorCode 								{ 0 };			// Color pulses
+		uint16_t 	m_ceRefreshCode 							{ 0 };			// Refresh check, half the Supply Voltage
+		uint16_t 	m_ceRefreshBleachCode 				{ 0 };			// Bleach refresh pulses
+		uint16_t 	m_ceRefreshColorCode 					{ 0 };			// Color refresh pulses
+
+		ecdSegmentMask_t m_refreshNeededMask 		{ 0 };			// Segments flagged for Refresh
+		ecdSegmentMask_t m_pulseMask 						{ 0 };			// Segments driven in the current Color or Bleach pulse
+		ecdSegmentMask_t m_pulseWaitingMask 		{ 0 };			// Segments of the current pulse whose drive group didn't start yet
+		ecdSegmentMask_t m_driveGroupMask[ECD_MAX_DRIVE_GROUPS] {};		// Segments of each drive group of the current pulse
+		uint8_t 				 m_driveGroupCount 			{ 1 };
+		uint16_t * m_segmentSamples;													// [LSB] - Last sampled voltage of each segment. See sampleSegments()
+
+		//REFRESH HISTORY - Open-circuit voltages sampled in each Refresh check
+		uint16_t 			(* m_historySamples)[REFRESH_HISTORY_DEPTH];	// [LSB]
+		uint8_t * 		m_historyCount;															// Valid samples of each segment since it was last driven
+		unsigned long m_historyTime[REFRESH_HISTORY_DEPTH];				// ms - millis() of each Refresh check
+		uint8_t 			m_historyHead 		{ 0 };										// Next position to write in the history
+		bool 					m_historyValid 		{ false };								// At least one Refresh check was done
+
+		//CHARGE ACCOUNTING - Estimated state of charge of each segment, see getSegmentCharge()
+		uint16_t * 		m_segmentCharge;														// [0 - ECD_CHARGE_FULL]
+		uint16_t 			m_chargeEmptyOffset 		{ 0 };							// [LSB] - Open-circuit voltage of a bleached segment, below the Counter Electrode
+		uint16_t 			m_chargeSpan 						{ 1 };							// [LSB] - Open-circuit voltage swing from bleached to colored
+		unsigned long m_refreshColorFullTime 	{ 0 };							// ms - Estimated time to color a segment with refresh pulses
+		unsigned long m_refreshBleachFullTime { 0 };							// ms - Estimated time to bleach a segment with refresh pulses
+		unsigned long m_pulseTime 						{ 0 };							// ms - Length of the current pulse
+		unsigned long m_pulseFullTime 				{ 1 };							// ms - Time for the current pulse to fully switch a segment
+		uint16_t 			m_pulseMargin 					{ 0 };							// Charge given past the target by the current pulse
+		uint32_t 			m_pulseChargeStart 			{ 0 };							// Charge of the refreshed segments before the current pulse
 
 		//PINS
 		int 		m_counterElectrodePin; 													// Counter Electrode Pin
-		int 		m_segmentPinsList[MAX_NUMBER_OF_SEGMENTS];			// Pin list for the Displays' Segments
+		int * 	m_segmentPinsList;													// Pin list for the Displays' Segments
+#if defined(YNV_ECD_FAST_GPIO)
+		uint8_t * 	m_segmentPort;													// PORT group of each segment
+		uint32_t * 	m_segmentPortBit;												// Bit of each segment in its PORT group
+		uint32_t 	m_portAllSegments[ECD_GPIO_NUM_PORTS] {};				// Bits of all the display's segments in each PORT group
+#endif
+
+#if defined(YNV_ECD_STATS)
+		ECD_Stats 	m_stats {};
+		uint16_t * 	m_sampleMin;														// [LSB] - Lowest sample of each segment
+		uint16_t * 	m_sampleMax;														// [LSB] - Highest sample of each segment
+#endif
 
-		static bool m_stopDrivingFlag;		// Use this flag to stop driving in any display
+		volatile bool m_stopDrivingFlag { false };		// Use this flag to stop driving this display
+		ecdOperation_t m_operation { ECD_NO_OPERATION };	// Last operation started
+		ECD_CommandQueue * m_commandQueue { nullptr };
+
+		//NON-BLOCKING DRIVING
+		ecdDriveState_e m_driveState 		{ ECD_STATE_IDLE };
+		unsigned long 	m_stateStartTime 	{ 0 };							// ms - millis() at which the current state started
+		unsigned long 	m_sliceStartTime 	{ 0 };							// ms - millis() at which the current closed-loop slice started
+		int 						m_refreshRetries 	{ 0 };
+		bool 						m_refreshBleachNeeded { false };
+		bool 						m_refreshColorNeeded 	{ false };
 
 		//FUNCTIONS
 		void updateRefreshLimits(void);
-		
+		void updateDacCodes(void);
+		uint16_t voltageToLsb(float t_voltage) const;
+		void updateChargeScale(void);
+
+		void enterState(ecdDriveState_e t_state, unsigned long t_now);
+		void startColorPhase(unsigned long t_now);
+		void startRefreshPhase(unsigned long t_now);
+		void startRefreshBleachPhase(unsigned long t_now);
+		void startRefreshColorPhase(unsigned long t_now);
+		void finishDriving();
+		ecdOperation_t startOperation();
+		bool processCommands();
+		bool readCommands(ecdCommand_e & t_command);
+		void discardCommands();
+
+		ecdSegmentMask_t segmentsInState(ecdSegmentState_e t_state) const;
+		ecdSegmentMask_t pendingSegments(ecdSegmentState_e t_state) const;
+
+		bool driveChangedSegments(ecdSegmentState_e t_state);
+		bool updateClosedLoopPulse(ecdSegmentState_e t_state, unsigned long t_now);
+		void driveRefreshSegments(ecdSegmentState_e t_state);
+		bool checkRefreshSegments(ecdSegmentState_e t_state, uint16_t t_limit);
+		bool flagRefreshSegments(unsigned long t_now);
+
+		void startPulse(ecdSegmentMask_t t_segments, ecdSegmentState_e t_state);
+		bool updateDriveGroups(ecdSegmentState_e t_state, unsigned long t_elapsed);
+		unsigned long pulsePhaseTime() const;
+		unsigned long segmentDriveTime(int t_segment, unsigned long t_elapsed) const;
+
+		void addCharge(int t_segment, ecdSegmentState_e t_state, unsigned long t_time);
+		unsigned long chargeBudgetTime(int t_segment, ecdSegmentState_e t_state) const;
+		bool updateChargeBudget(ecdSegmentState_e t_state, unsigned long t_elapsed);
+		void endPulse(ecdSegmentState_e t_state, unsigned long t_elapsed);
+		void estimateCharge(ecdSegmentMask_t t_segments, uint16_t t_ceCode);
+		void learnRefreshRate(ecdSegmentState_e t_state, ecdSegmentMask_t t_segments);
+
+		void sampleSegments();
+		void recordRefreshHistory(unsigned long t_now);
+		void resetHistory(ecdSegmentMask_t t_segments);
+
+		void driveSegments(ecdSegmentMask_t t_segments, ecdSegmentState_e t_state);
+		void disableSegments(ecdSegmentMask_t t_segments);
 		void disableAllSegments();
 
-		void enableCounterElectrode(float t_voltage);
+		void enableCounterElectrode(uint16_t t_dacCode);
 
 		void disableCounterElectrode();
 		
 };
 
+/**
+ * Ynvisible's Electrochromic Display driver, with up to MAX_NUMBER_OF_SEGMENTS segments
+ */
+class YNV_ECD : public YNV_ECD_BASE
+{
+	public:
+		YNV_ECD(int t_numberOfSegments, int* t_segments);
+
+	private:
+		ECD_SegmentStorage<MAX_NUMBER_OF_SEGMENTS> m_storage;
+};
+
+/**
+ * Ynvisible's Electrochromic Display driver with the number of segments fixed at compile time.
+ * The per-segment storage is sized exactly for the display, and the pin list size is checked
+ * by the compiler. e.g.:
+ * 	const int pins[3] = {PIN_SEG_2, PIN_SEG_1, PIN_SEG_3};
+ * 	YNV_ECD_T<3> display(pins);
+ */
+template<int t_numberOfSegments>
+class YNV_ECD_T : public YNV_ECD_BASE
+{
+	static_assert(t_numberOfSegments >= 1 && t_numberOfSegments <= 32, "YNV_ECD_T supports 1 to 32 segments");
+
+	public:
+		YNV_ECD_T(const int (&t_segments)[t_numberOfSegments]) { attachSegments(t_numberOfSegments, t_segments, m_storage.buffers()); }
+		static constexpr int numberOfSegments() { return t_numberOfSegments; }
+
+	private:
+		ECD_SegmentStorage<t_numberOfSegments> m_storage;
+};
+
 #endif	// _YNVISIBLE_ECD
\ No newline at end of file
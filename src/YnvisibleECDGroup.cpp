@@ -0,0 +1,670 @@
+/**
+ * Shared Counter Electrode scheduler for Ynvisible Electrochromic Displays
+ */
+#include "Arduino.h"
+#include "YnvisibleECD.h"
+#include "YnvisibleECDGroup.h"
+
+
+/*********************** PUBLIC FUNCTIONS ************************/
+
+/**
+ * @brief Add a display to the group
+ * 
+ * @param t_display display sharing the group's Counter Electrode
+ * @return true if the display was added, false if the group is full or busy
+ */
+bool YNV_ECD_GROUP::addDisplay(YNV_ECD_BASE * t_display){
+  if(t_display == NULL || m_numberOfDisplays >= ECD_GROUP_MAX_DISPLAYS || isBusy()){
+    return false;
+  }
+  m_displays[m_numberOfDisplays++] = t_display;
+  return true;
+}
+
+/**
+ * Colors and bleaches the pending segments of all displays in the group.
+ * Change the segments' state of each display with YNV_ECD.setSegmentState() and
+ * then call this method to apply all new states at once.
+ * @note this method blocks until the driving is done. Use YNV_ECD_GROUP.beginExecute()
+ * and YNV_ECD_GROUP.update() for non-blocking driving.
+ */
+void YNV_ECD_GROUP::executeDisplays(){
+  waitForIdle();
+  beginExecute();
+  while(update(ynvHalMillis()) == false){
+    ynvHalYield();
+  }
+}
+
+/**
+ * @brief Start a non-blocking Execute of all displays in the group
+ * 
+ * Call YNV_ECD_GROUP.update() periodically until it returns true.
+ * 
+ * @return true if at least one display is being driven, false if the group or one of
+ * its displays is busy, or nothing changed since the last Execute
+ */
+bool YNV_ECD_GROUP::beginExecute(){
+  if(isBusy() || isDisplayBusy()){
+    return false;
+  }
+
+  m_conditioning = false;
+  m_activeMask = 0;
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    if(m_displays[d]->m_stopDrivingFlag == false){
+      m_displays[d]->discardCommands();     // Left over from an earlier driving
+      m_activeMask |= 1 << d;
+    }
+  }
+  if(m_activeMask == 0){
+    return false;
+  }
+  if(hasPendingSegments(SEGMENT_STATE_BLEACH) == false && hasPendingSegments(SEGMENT_STATE_COLOR) == false){
+    return false;     // Nothing changed since the last Execute
+  }
+
+  if(hasPendingSegments(SEGMENT_STATE_BLEACH) == false){
+    startColorPhase(ynvHalMillis());
+    return true;
+  }
+  m_displays[0]->enableCounterElectrode(m_displays[0]->m_ceBleachCode);
+  enterState(ECD_GROUP_STATE_BLEACH_SETTLE, ynvHalMillis());
+  return true;
+}
+
+/**
+ * Start up all displays of the group whose segment state is unknown.
+ * Call it at boot instead of YNV_ECD.begin() on each display.
+ * @note this method blocks until the driving is done. Use YNV_ECD_GROUP.beginStartup()
+ * and YNV_ECD_GROUP.update() for non-blocking driving.
+ * 
+ * @param t_mode ECD_STARTUP_FAST or ECD_STARTUP_FULL
+ */
+void YNV_ECD_GROUP::startupDisplays(ecdStartupMode_e t_mode){
+  waitForIdle();
+  beginStartup(t_mode);
+  while(update(ynvHalMillis()) == false){
+    ynvHalYield();
+  }
+}
+
+/**
+ * @brief Start a non-blocking startup of the displays in the group
+ * 
+ * Every display with a segment in an undefined state is bleached, with one pulse shared
+ * by all of them. ECD_STARTUP_FULL colors them first, like YNV_ECD.begin(), for displays
+ * that need the full conditioning (e.g. first boot or after a long storage).
+ * Displays with a known state, e.g. restored with YNV_CALIBRATION_STORE.resume() after
+ * a reset, are skipped. Each driven display is then refreshed.
+ * 
+ * Call YNV_ECD_GROUP.update() periodically until it returns true.
+ * 
+ * @param t_mode ECD_STARTUP_FAST or ECD_STARTUP_FULL
+ * @return true if at least one display is being started up, false if nothing needs it
+ * or the group or one of its displays is busy
+ */
+bool YNV_ECD_GROUP::beginStartup(ecdStartupMode_e t_mode){
+  if(isBusy() || isDisplayBusy()){
+    return false;
+  }
+
+  m_activeMask = 0;
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    YNV_ECD_BASE * display = m_displays[d];
+
+    if(display->m_stopDrivingFlag == true || display->m_currentDefinedMask == display->m_allSegmentsMask){
+      continue;
+    }
+    display->setFrame((t_mode == ECD_STARTUP_FULL) ? display->m_allSegmentsMask : 0);
+    display->discardCommands();
+    m_activeMask |= 1 << d;
+  }
+  if(m_activeMask == 0){
+    return false;       // Nothing to start up
+  }
+
+  m_conditioning = (t_mode == ECD_STARTUP_FULL);
+  if(m_conditioning){
+    startColorPhase(ynvHalMillis());
+  }
+  else{
+    m_displays[0]->enableCounterElectrode(m_displays[0]->m_ceBleachCode);
+    enterState(ECD_GROUP_STATE_BLEACH_SETTLE, ynvHalMillis());
+  }
+  return true;
+}
+
+/**
+ * Refresh all displays of the group with one shared Refresh.
+ * Replaces YNV_ECD.refreshDisplay() on each display: the Counter Electrode is biased
+ * and settled once, and the segments of every display share the refresh pulses.
+ * @note this method blocks until the refresh is done. Use YNV_ECD_GROUP.beginRefresh()
+ * and YNV_ECD_GROUP.update() for non-blocking driving.
+ */
+void YNV_ECD_GROUP::refreshDisplays(){
+  waitForIdle();
+  beginRefresh();
+  while(update(ynvHalMillis()) == false){
+    ynvHalYield();
+  }
+}
+
+/**
+ * @brief Start a non-blocking Refresh of all displays in the group
+ * 
+ * Every display is sampled after one Counter Electrode settling time. The segments past
+ * their Refresh limit, in any display, are then refreshed with one Bleach and one Color
+ * refresh cycle for the whole group, instead of one cycle per display.
+ * 
+ * Call YNV_ECD_GROUP.update() periodically until it returns true.
+ * 
+ * @return true if at least one display is being refreshed, false if the group or one
+ * of its displays is busy
+ */
+bool YNV_ECD_GROUP::beginRefresh(){
+  if(isBusy() || isDisplayBusy()){
+    return false;
+  }
+
+  m_conditioning = false;
+  m_activeMask = 0;
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    if(m_displays[d]->m_stopDrivingFlag == false){
+      m_displays[d]->discardCommands();     // Left over from an earlier driving
+      m_activeMask |= 1 << d;
+    }
+  }
+  if(m_activeMask == 0){
+    return false;
+  }
+  startRefreshPhase(ynvHalMillis());
+  return true;
+}
+
+/**
+ * @brief Advance the non-blocking driving of the group
+ * 
+ * @param t_now current time in ms, usually millis()
+ * @return true if the group is idle (driving done or stopped), false otherwise
+ */
+bool YNV_ECD_GROUP::update(unsigned long t_now){
+  while(m_groupState != ECD_GROUP_STATE_IDLE){
+    if(dropStoppedDisplays() == true){
+      finishDriving();
+      return true;
+    }
+
+    unsigned long elapsed = t_now - m_stateStartTime;
+
+    switch(m_groupState){
+      case ECD_GROUP_STATE_BLEACH_SETTLE:
+        if(elapsed < COUNTER_ELECTRODE_SETTLE_TIME){
+          return false;
+        }
+        if(driveChangedSegments(SEGMENT_STATE_BLEACH) == true){
+          enterState(ECD_GROUP_STATE_BLEACH_PULSE, t_now);
+        }
+        else{
+          startColorPhase(t_now);
+        }
+      break;
+
+      case ECD_GROUP_STATE_BLEACH_PULSE:
+      case ECD_GROUP_STATE_COLOR_PULSE:
+        if(elapsed < m_pulseTime && updatePulse(elapsed, t_now) == true){
+          return false;
+        }
+        endPulse(elapsed);
+        if(m_groupState == ECD_GROUP_STATE_BLEACH_PULSE){
+          startColorPhase(t_now);
+        }
+        else{
+          startRefreshPhase(t_now);
+        }
+      break;
+
+      case ECD_GROUP_STATE_COLOR_SETTLE:
+        if(elapsed < COUNTER_ELECTRODE_SETTLE_TIME){
+          return false;
+        }
+        if(driveChangedSegments(SEGMENT_STATE_COLOR) == true){
+          enterState(ECD_GROUP_STATE_COLOR_PULSE, t_now);
+        }
+        else{
+          startRefreshPhase(t_now);
+        }
+      break;
+
+      case ECD_GROUP_STATE_REFRESH_SETTLE:
+        if(elapsed < COUNTER_ELECTRODE_SETTLE_TIME){
+          return false;
+        }
+        disableAllSegments();
+        if(flagRefreshSegments(t_now) == false){
+          finishDriving();      // No display needs a Refresh
+          break;
+        }
+        startRefreshBleachPhase(t_now);
+      break;
+
+      case ECD_GROUP_STATE_REFRESH_BLEACH_SETTLE:
+        if(elapsed < COUNTER_ELECTRODE_SETTLE_TIME){
+          return false;
+        }
+        if(driveRefreshSegments(SEGMENT_STATE_BLEACH) == true){
+          enterState(ECD_GROUP_STATE_REFRESH_BLEACH_PULSE, t_now);
+        }
+        else{
+          startRefreshColorPhase(t_now);
+        }
+      break;
+
+      case ECD_GROUP_STATE_REFRESH_BLEACH_PULSE:
+      case ECD_GROUP_STATE_REFRESH_COLOR_PULSE:
+        if(elapsed < m_pulseTime && updatePulse(elapsed, t_now) == true){
+          return false;
+        }
+        disableAllSegments();
+        endPulse(elapsed);
+
+        if(checkRefreshSegments(pulseState()) == true){
+          enterState((m_groupState == ECD_GROUP_STATE_REFRESH_BLEACH_PULSE) ? ECD_GROUP_STATE_REFRESH_BLEACH_WAIT : ECD_GROUP_STATE_REFRESH_COLOR_WAIT, t_now);
+        }
+        else if(m_groupState == ECD_GROUP_STATE_REFRESH_BLEACH_PULSE){
+          startRefreshColorPhase(t_now);    // Every segment converged, no need to wait
+        }
+        else{
+          finishDriving();
+        }
+      break;
+
+      case ECD_GROUP_STATE_REFRESH_BLEACH_WAIT:
+        if(elapsed < (unsigned long)m_displays[0]->m_cfg.refreshRetryInterval){
+          return false;
+        }
+        driveRefreshSegments(SEGMENT_STATE_BLEACH);
+        enterState(ECD_GROUP_STATE_REFRESH_BLEACH_PULSE, t_now);
+      break;
+
+      case ECD_GROUP_STATE_REFRESH_COLOR_SETTLE:
+        if(elapsed < COUNTER_ELECTRODE_SETTLE_TIME){
+          return false;
+        }
+        if(driveRefreshSegments(SEGMENT_STATE_COLOR) == true){
+          enterState(ECD_GROUP_STATE_REFRESH_COLOR_PULSE, t_now);
+        }
+        else{
+          finishDriving();
+        }
+      break;
+
+      case ECD_GROUP_STATE_REFRESH_COLOR_WAIT:
+        if(elapsed < (unsigned long)m_displays[0]->m_cfg.refreshRetryInterval){
+          return false;
+        }
+        driveRefreshSegments(SEGMENT_STATE_COLOR);
+        enterState(ECD_GROUP_STATE_REFRESH_COLOR_PULSE, t_now);
+      break;
+
+      default:
+        finishDriving();
+      break;
+    }
+  }
+  return true;
+}
+
+/********************* END PUBLIC FUNCTIONS **********************/
+
+
+/*********************** PRIVATE FUNCTIONS ***********************/
+
+void YNV_ECD_GROUP::enterState(ecdGroupState_e t_state, unsigned long t_now){
+  m_groupState = t_state;
+  m_stateStartTime = t_now;
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    m_displays[d]->m_sliceStartTime = t_now;      // Closed-loop slices start with the shared pulse
+  }
+}
+
+/**
+ * @brief Remove the displays stopped with YNV_ECD.setStopDrivingFlag() or a queued command from the group's driving
+ * 
+ * Their segments are released right away, the other displays keep their pulses.
+ * The Counter Electrode is shared, so ECD_COMMAND_CLEAR can't bleach the display now:
+ * all its segments are left pending Bleach for its next Execute.
+ * 
+ * @return true if no display is left
+ */
+bool YNV_ECD_GROUP::dropStoppedDisplays(){
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    YNV_ECD_BASE * display = m_displays[d];
+    ecdCommand_e command;
+    bool stop;
+
+    if(isActive(d) == false){
+      continue;
+    }
+    stop = display->m_stopDrivingFlag;
+    if(display->readCommands(command) == true){
+      stop = true;
+      if(command == ECD_COMMAND_CLEAR){
+        display->setAllSegmentsBleach();
+      }
+    }
+    if(stop){
+      display->disableAllSegments();      // The Counter Electrode is shared, leave it on
+      m_activeMask &= ~(1 << d);
+    }
+  }
+  return m_activeMask == 0;
+}
+
+/**
+ * @brief Block until the group and each of its displays are done with their non-blocking driving
+ */
+void YNV_ECD_GROUP::waitForIdle(){
+  while(update(ynvHalMillis()) == false){
+    ynvHalYield();
+  }
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    while(m_displays[d]->update(ynvHalMillis()) == false){
+      ynvHalYield();
+    }
+  }
+}
+
+/**
+ * @brief Check if a display of the group runs its own non-blocking Execute or Refresh
+ * 
+ * Its pins and the shared Counter Electrode are in use, the group must not start a pulse on top.
+ */
+bool YNV_ECD_GROUP::isDisplayBusy() const{
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    if(m_displays[d]->isBusy()){
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Check if any display has segments changing to a given state
+ */
+bool YNV_ECD_GROUP::hasPendingSegments(ecdSegmentState_e t_state){
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    if(isActive(d) && m_displays[d]->pendingSegments(t_state) != 0){
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Drive the segments that change to a given state, in every display
+ * 
+ * Also sets the shared pulse time to the longest one of the displays being driven.
+ * Every drive group of every display is driven for that time, so the shared pulse
+ * ends when the last group of the display with the most staggered groups ends.
+ * 
+ * @param t_state state being applied: SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ * @return true if at least one segment is being driven
+ */
+bool YNV_ECD_GROUP::driveChangedSegments(ecdSegmentState_e t_state){
+  bool isDelayRequired = false;
+  unsigned long pulseTime = 0;
+
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    YNV_ECD_BASE * display = m_displays[d];
+
+    if(isActive(d) && display->driveChangedSegments(t_state) == true){
+      if(display->m_pulseTime > pulseTime){
+        pulseTime = display->m_pulseTime;
+      }
+      isDelayRequired = true;
+    }
+  }
+
+  m_pulseTime = 0;
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    YNV_ECD_BASE * display = m_displays[d];
+
+    if(isActive(d) && (display->m_pulseMask | display->m_pulseWaitingMask) != 0){
+      display->m_pulseTime = pulseTime;
+      if(display->pulsePhaseTime() > m_pulseTime){
+        m_pulseTime = display->pulsePhaseTime();
+      }
+    }
+  }
+  return isDelayRequired;
+}
+
+/**
+ * @brief State driven by the current shared pulse
+ */
+ecdSegmentState_e YNV_ECD_GROUP::pulseState() const{
+  if(m_groupState == ECD_GROUP_STATE_COLOR_PULSE || m_groupState == ECD_GROUP_STATE_REFRESH_COLOR_PULSE){
+    return SEGMENT_STATE_COLOR;
+  }
+  return SEGMENT_STATE_BLEACH;
+}
+
+/**
+ * @brief Start the staggered drive groups and release the segments whose charge budget is spent
+ * or, with ECD_Config.closedLoopDrive, that reached their target, in every display
+ * 
+ * Displays without ECD_Config.chargeBudgetDrive keep each drive group driven for the shared pulse time.
+ * As in YNV_ECD.update(), the closed-loop checks only apply to the Bleach and Color pulses.
+ * 
+ * @param t_elapsed ms - time since the shared pulse started
+ * @param t_now ms - current time
+ * @return true if the pulse must go on
+ */
+bool YNV_ECD_GROUP::updatePulse(unsigned long t_elapsed, unsigned long t_now){
+  ecdSegmentState_e state = pulseState();
+  bool closedLoop = (m_groupState == ECD_GROUP_STATE_BLEACH_PULSE || m_groupState == ECD_GROUP_STATE_COLOR_PULSE);
+  bool isDriving = false;
+
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    YNV_ECD_BASE * display = m_displays[d];
+
+    if(isActive(d) && display->updateDriveGroups(state, t_elapsed) == true && display->updateChargeBudget(state, t_elapsed) == true &&
+       (closedLoop == false || display->updateClosedLoopPulse(state, t_now) == true)){
+      isDriving = true;
+    }
+  }
+  return isDriving;
+}
+
+/**
+ * @brief Account the charge of the segments driven by the shared pulse, in every display
+ * 
+ * @param t_elapsed ms - length of the shared pulse
+ */
+void YNV_ECD_GROUP::endPulse(unsigned long t_elapsed){
+  ecdSegmentState_e state = pulseState();
+
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    if(isActive(d)){
+      m_displays[d]->endPulse(state, t_elapsed);
+    }
+  }
+}
+
+/**
+ * @brief End the shared Bleach phase and start the shared Color phase
+ */
+void YNV_ECD_GROUP::startColorPhase(unsigned long t_now){
+  YNV_ECD_BASE * reference = m_displays[0];
+
+  disableAllSegments();
+  if(hasPendingSegments(SEGMENT_STATE_COLOR) == false){
+    startRefreshPhase(t_now);
+    return;
+  }
+  reference->enableCounterElectrode(reference->m_ceColorCode);
+  enterState(ECD_GROUP_STATE_COLOR_SETTLE, t_now);
+}
+
+/**
+ * @brief End the shared Color phase and start the shared Refresh
+ */
+void YNV_ECD_GROUP::startRefreshPhase(unsigned long t_now){
+  disableAllSegments();
+  m_displays[0]->disableCounterElectrode();
+
+  if(m_conditioning == true){
+    // ECD_STARTUP_FULL: the Color pulse is done, bleach everything before refreshing
+    m_conditioning = false;
+    for(int d = 0; d < m_numberOfDisplays; d++){
+      if(isActive(d)){
+        m_displays[d]->setFrame(0);
+      }
+    }
+    m_displays[0]->enableCounterElectrode(m_displays[0]->m_ceBleachCode);
+    enterState(ECD_GROUP_STATE_BLEACH_SETTLE, t_now);
+    return;
+  }
+
+#if defined(YNV_ECD_STATS)
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    if(isActive(d)){
+      m_displays[d]->m_stats.refreshes++;
+    }
+  }
+#endif
+  m_displays[0]->enableCounterElectrode(m_displays[0]->m_ceRefreshCode);
+  enterState(ECD_GROUP_STATE_REFRESH_SETTLE, t_now);
+}
+
+/**
+ * @brief Sample every display and flag the segments past their Refresh limit
+ * 
+ * @return true if at least one display needs a Refresh
+ */
+bool YNV_ECD_GROUP::flagRefreshSegments(unsigned long t_now){
+  bool isRefreshRequired = false;
+
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    if(isActive(d) && m_displays[d]->flagRefreshSegments(t_now) == true){
+      isRefreshRequired = true;
+    }
+  }
+  return isRefreshRequired;
+}
+
+/**
+ * @brief Check if any display still has segments to refresh in a given state
+ */
+bool YNV_ECD_GROUP::isRefreshNeeded(ecdSegmentState_e t_state){
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    YNV_ECD_BASE * display = m_displays[d];
+
+    if(isActive(d) && ((t_state == SEGMENT_STATE_COLOR) ? display->m_refreshColorNeeded : display->m_refreshBleachNeeded)){
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Drive the segments flagged for refresh in a given state, in every display
+ * 
+ * Each display keeps its own refresh pulse time. The shared pulse lasts until the
+ * longest one ends.
+ * 
+ * @param t_state state being refreshed: SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ * @return true if at least one segment is being driven
+ */
+bool YNV_ECD_GROUP::driveRefreshSegments(ecdSegmentState_e t_state){
+  bool isDelayRequired = false;
+
+  m_pulseTime = 0;
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    YNV_ECD_BASE * display = m_displays[d];
+
+    if(isActive(d) && ((t_state == SEGMENT_STATE_COLOR) ? display->m_refreshColorNeeded : display->m_refreshBleachNeeded)){
+      display->driveRefreshSegments(t_state);
+      if(display->pulsePhaseTime() > m_pulseTime){
+        m_pulseTime = display->pulsePhaseTime();
+      }
+      isDelayRequired = true;
+    }
+  }
+  return isDelayRequired;
+}
+
+/**
+ * @brief Check which segments still need a refresh pulse, in every display just refreshed
+ * 
+ * @param t_state state being refreshed: SEGMENT_STATE_BLEACH or SEGMENT_STATE_COLOR
+ * @return true if at least one segment still needs refresh
+ */
+bool YNV_ECD_GROUP::checkRefreshSegments(ecdSegmentState_e t_state){
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    YNV_ECD_BASE * display = m_displays[d];
+
+    if(isActive(d) == false){
+      continue;
+    }
+    if(t_state == SEGMENT_STATE_COLOR && display->m_refreshColorNeeded){
+      display->m_refreshColorNeeded = display->checkRefreshSegments(SEGMENT_STATE_COLOR, display->m_refreshColorLimitH);
+      display->m_refreshRetries++;
+    }
+    else if(t_state == SEGMENT_STATE_BLEACH && display->m_refreshBleachNeeded){
+      display->m_refreshBleachNeeded = display->checkRefreshSegments(SEGMENT_STATE_BLEACH, display->m_refreshBleachLimitL);
+      display->m_refreshRetries++;
+    }
+  }
+  return isRefreshNeeded(t_state);
+}
+
+/**
+ * @brief Start the shared Bleach refresh, or the Color refresh if no segment needs bleaching
+ */
+void YNV_ECD_GROUP::startRefreshBleachPhase(unsigned long t_now){
+  if(isRefreshNeeded(SEGMENT_STATE_BLEACH) == false){
+    startRefreshColorPhase(t_now);    // Skip the Bleach refresh and its settling time
+    return;
+  }
+  m_displays[0]->enableCounterElectrode(m_displays[0]->m_ceRefreshBleachCode);
+  enterState(ECD_GROUP_STATE_REFRESH_BLEACH_SETTLE, t_now);
+}
+
+/**
+ * @brief End the shared Bleach refresh and start the shared Color refresh
+ */
+void YNV_ECD_GROUP::startRefreshColorPhase(unsigned long t_now){
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    m_displays[d]->m_refreshRetries = 0;
+  }
+  if(isRefreshNeeded(SEGMENT_STATE_COLOR) == false){
+    finishDriving();
+    return;
+  }
+  m_displays[0]->enableCounterElectrode(m_displays[0]->m_ceRefreshColorCode);
+  enterState(ECD_GROUP_STATE_REFRESH_COLOR_SETTLE, t_now);
+}
+
+/**
+ * @brief Set the segments of every display to High-Impedance
+ */
+void YNV_ECD_GROUP::disableAllSegments(){
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    m_displays[d]->disableAllSegments();
+  }
+}
+
+/**
+ * @brief Release all pins and return to idle
+ */
+void YNV_ECD_GROUP::finishDriving(){
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    m_displays[d]->finishDriving();
+  }
+  m_conditioning = false;
+  m_groupState = ECD_GROUP_STATE_IDLE;
+}
+/********************* END PRIVATE FUNCTIONS **********************/
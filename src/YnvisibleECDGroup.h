@@ -0,0 +1,109 @@
+/*
+	YnvisibleECDGroup.h - Drive several Ynvisible Electrochromic Displays together
+	For Driver 5.x Hardware
+*/
+
+#ifndef _YNVISIBLE_ECD_GROUP
+#define _YNVISIBLE_ECD_GROUP
+
+#include "Arduino.h"
+#include "YnvisibleECD.h"
+
+#define ECD_GROUP_MAX_DISPLAYS 		6
+
+enum ecdGroupState_e{
+	ECD_GROUP_STATE_IDLE = 0,
+	ECD_GROUP_STATE_BLEACH_SETTLE,		// Counter Electrode settling for the shared Bleach pulse
+	ECD_GROUP_STATE_BLEACH_PULSE,			// Shared Bleach pulse on-going
+	ECD_GROUP_STATE_COLOR_SETTLE,			// Counter Electrode settling for the shared Color pulse
+	ECD_GROUP_STATE_COLOR_PULSE,			// Shared Color pulse on-going
+	ECD_GROUP_STATE_REFRESH_SETTLE,		// Counter Electrode settling at half the supply, before sampling every display
+	ECD_GROUP_STATE_REFRESH_BLEACH_SETTLE,
+	ECD_GROUP_STATE_REFRESH_BLEACH_PULSE,
+	ECD_GROUP_STATE_REFRESH_BLEACH_WAIT,
+	ECD_GROUP_STATE_REFRESH_COLOR_SETTLE,
+	ECD_GROUP_STATE_REFRESH_COLOR_PULSE,
+	ECD_GROUP_STATE_REFRESH_COLOR_WAIT
+};
+
+/**
+ * Startup of the displays whose segment state is unknown.
+ * See YNV_ECD_GROUP::beginStartup()
+ */
+enum ecdStartupMode_e{
+	ECD_STARTUP_FAST = 0,							// One shared Bleach pulse
+	ECD_STARTUP_FULL									// Shared Color pulse, then shared Bleach pulse. Same conditioning as YNV_ECD.begin()
+};
+
+/**
+ * Group of displays sharing the same Counter Electrode.
+ * 
+ * Pending segment changes of every display in the group are applied with one
+ * shared Bleach pulse and one shared Color pulse, so updating N displays costs
+ * about one pulse pair instead of N.
+ * 
+ * The Counter Electrode voltages are taken from the first display added to the group.
+ * The pulse times are the longest ones of the displays with segments to change.
+ * Within the shared pulse each display keeps its own drive groups, charge budget and
+ * closed-loop drive (ECD_Config.closedLoopDrive): its segments are released on their own.
+ * The Refresh is shared too: the Counter Electrode is biased once, every display is
+ * sampled, and the segments past their limit in all displays get the same Bleach and
+ * Color refresh pulses. Each display keeps its own refresh pulse time and retries.
+ * Stopping one display (YNV_ECD.setStopDrivingFlag() or a command in its queue, see
+ * YNV_ECD.setCommandQueue()) only removes that display from the group's driving, the others carry on.
+ * 
+ * At boot, startupDisplays() replaces YNV_ECD.begin() on each display: the displays
+ * with an unknown state share the startup pulses, and the ones restored with
+ * YNV_CALIBRATION_STORE.resume() are left as they are.
+ */
+class YNV_ECD_GROUP
+{
+	public:
+		YNV_ECD_GROUP() {}
+
+		bool addDisplay(YNV_ECD_BASE * t_display);
+		int  getNumberOfDisplays() const { return m_numberOfDisplays; }
+
+		void executeDisplays();
+		bool beginExecute();
+		void startupDisplays(ecdStartupMode_e t_mode = ECD_STARTUP_FAST);
+		bool beginStartup(ecdStartupMode_e t_mode = ECD_STARTUP_FAST);
+		void refreshDisplays();
+		bool beginRefresh();
+		bool update(unsigned long t_now);
+		bool poll() { return update(ynvHalMillis()); }
+		bool isBusy() const { return m_groupState != ECD_GROUP_STATE_IDLE; }
+
+	private:
+		YNV_ECD_BASE * 			m_displays[ECD_GROUP_MAX_DISPLAYS];
+		int 						m_numberOfDisplays 	{ 0 };
+
+		ecdGroupState_e m_groupState 				{ ECD_GROUP_STATE_IDLE };
+		unsigned long 	m_stateStartTime 		{ 0 };
+		unsigned long 	m_pulseTime 				{ 0 };					// ms - duration of the current shared pulse
+		uint8_t 				m_activeMask 				{ 0 };					// Displays taking part in the current Execute, bit d = display d
+		bool 						m_conditioning 			{ false };			// ECD_STARTUP_FULL: Bleach everything after the Color pulse
+
+		void enterState(ecdGroupState_e t_state, unsigned long t_now);
+		bool isActive(int t_display) const { return (m_activeMask >> t_display) & 1; }
+		bool isDisplayBusy() const;
+		void waitForIdle();
+		bool dropStoppedDisplays();
+		bool hasPendingSegments(ecdSegmentState_e t_state);
+		bool driveChangedSegments(ecdSegmentState_e t_state);
+		ecdSegmentState_e pulseState() const;
+		bool updatePulse(unsigned long t_elapsed, unsigned long t_now);
+		void endPulse(unsigned long t_elapsed);
+		void startColorPhase(unsigned long t_now);
+		void startRefreshPhase(unsigned long t_now);
+		bool flagRefreshSegments(unsigned long t_now);
+		bool isRefreshNeeded(ecdSegmentState_e t_state);
+		bool driveRefreshSegments(ecdSegmentState_e t_state);
+		bool checkRefreshSegments(ecdSegmentState_e t_state);
+		void startRefreshBleachPhase(unsigned long t_now);
+		void startRefreshColorPhase(unsigned long t_now);
+		void disableAllSegments();
+		void finishDriving();
+};
+
+#endif	// _YNVISIBLE_ECD_GROUP
@@ -1,5 +1,6 @@
 #include "YnvisibleECD.h"
 #include "YnvisibleEvaluationKit.h"
+#include "YnvisibleFont.h"
 
 int evalKitSinglePinList = EVAL_KIT_SINGLE_PIN_LIST;
 int evalKit7SegDotPinList[EVAL_KIT_7SEG_DOT_NUM_SEGMENTS] = EVAL_KIT_7SEG_DOT_PIN_LIST;
@@ -9,7 +10,6 @@ int evalKit3BarsPinList[EVAL_KIT_3BARS_NUM_SEGMENTS] = EVAL_KIT_3BARS_PIN_LIST;
 int evalKit7BarsPinList[EVAL_KIT_7BARS_NUM_SEGMENTS] = EVAL_KIT_7BARS_PIN_LIST;
 
 static YNV_ECD * p_currentDisplay;
-bool YNV_ECD::m_stopDrivingFlag = false;
 
 YNV_ECD ecdEvalKitSingle(EVAL_KIT_SINGLE_NUM_SEGMENTS, &evalKitSinglePinList);                   // Object for a Single Segment Electrochromic Display
 YNV_ECD ecdEvalKit7SegDot(EVAL_KIT_7SEG_DOT_NUM_SEGMENTS, evalKit7SegDotPinList);                         // Object for a 7-Segment Electrochromic Display
@@ -18,22 +18,42 @@ YNV_ECD ecdEvalKit15SegDot(EVAL_KIT_15SEG_DOT_NUM_SEGMENTS, evalKit15SegDotPinLi
 YNV_ECD ecdEvalKit3Bars(EVAL_KIT_3BARS_NUM_SEGMENTS, evalKit3BarsPinList);                      // Object for a 3 Bars (Segments) Electrochromic Display -> Bottom to Top
 YNV_ECD ecdEvalKit7Bars(EVAL_KIT_7BARS_NUM_SEGMENTS, evalKit7BarsPinList);                      // Object for a 7 Bars (Segments) Electrochromic Display -> Bottom to Top
 
-EK_15Seg_Values_t last15SegNumber {0, 0};
-bool display15SegDotUpdateTens = false;
-bool display15SegNegUpdateTens = false;
-
-const bool mask7SegDotsDisplay [EVAL_KIT_7SEG_DOT_MASK_NUM_OF_ANIMATIONS][EVAL_KIT_7SEG_DOT_NUM_SEGMENTS] = {
-    {1,1,1,1,1,1,0},  // 0
-    {0,1,1,0,0,0,0},  // 1
-    {1,1,0,1,1,0,1},  // 2
-    {1,1,1,1,0,0,1},  // 3
-    {0,1,1,0,0,1,1},  // 4
-    {1,0,1,1,0,1,1},  // 5
-    {1,0,1,1,1,1,1},  // 6
-    {1,1,1,0,0,0,0},  // 7
-    {1,1,1,1,1,1,1},  // 8
-    {1,1,1,1,0,1,1},  // 9
-    {0,0,0,0,0,0,0}   // "10" - All OFF
+YNV_ANIMATION evalKitAnimation;                                                                 // Keyframe animations player
+YNV_SUPPLY_MONITOR evalKitSupply;                                                               // Keeps the displays' limits matched to the Supply Voltage
+
+// Digits shown by each display, the "from" side of their transition plans
+static uint8_t last15SegNegDigits[2] = {FONT_BLANK_DIGIT, FONT_BLANK_DIGIT};
+static uint8_t last15SegDotDigits[2] = {FONT_BLANK_DIGIT, FONT_BLANK_DIGIT};
+static uint8_t last7SegDotDigit = FONT_BLANK_DIGIT;
+
+// 7-Segment layout, the Dot is wired to segment 3
+const int8_t font7SegDotMap[FONT_GLYPH_BITS] = {0, 1, 2, 4, 5, 6, 7, 3};
+const ECD_FontLayout font7SegDotLayout = {font7SegDotMap, 1};
+
+// Double 7-Segment layout, segment 0 is the Minus or Dot and is driven apart
+const int8_t font15SegMap[2 * FONT_GLYPH_BITS] = {
+    1, 2, 3, 4, 5, 6, 7, FONT_NO_SEGMENT,          // Tens
+    8, 9, 10, 11, 12, 13, 14, FONT_NO_SEGMENT      // Units
+};
+const ECD_FontLayout font15SegLayout = {font15SegMap, 2};
+
+// Bar displays keyframes
+const ECD_Keyframe keyframes7BarsCountUp[] = {
+    {0x01, EVAL_KIT_7BAR_COUNT_DELAY}, {0x03, EVAL_KIT_7BAR_COUNT_DELAY}, {0x07, EVAL_KIT_7BAR_COUNT_DELAY}, {0x0F, EVAL_KIT_7BAR_COUNT_DELAY},
+    {0x1F, EVAL_KIT_7BAR_COUNT_DELAY}, {0x3F, EVAL_KIT_7BAR_COUNT_DELAY}, {0x7F, EVAL_KIT_7BAR_COUNT_DELAY}, {0x00, 0}
+};
+const ECD_Keyframe keyframes7BarsCountDown[] = {
+    {0x40, EVAL_KIT_7BAR_COUNT_DELAY}, {0x60, EVAL_KIT_7BAR_COUNT_DELAY}, {0x70, EVAL_KIT_7BAR_COUNT_DELAY}, {0x78, EVAL_KIT_7BAR_COUNT_DELAY},
+    {0x7C, EVAL_KIT_7BAR_COUNT_DELAY}, {0x7E, EVAL_KIT_7BAR_COUNT_DELAY}, {0x7F, EVAL_KIT_7BAR_COUNT_DELAY}, {0x00, 0}
+};
+const ECD_Keyframe keyframes3BarsCountUp[] = {
+    {0x01, EVAL_KIT_3BAR_COUNT_DELAY}, {0x03, EVAL_KIT_3BAR_COUNT_DELAY}, {0x07, 3 * EVAL_KIT_3BAR_COUNT_DELAY}, {0x00, EVAL_KIT_3BAR_COUNT_DELAY}
+};
+const ECD_Keyframe keyframes3BarsCountDown[] = {
+    {0x04, EVAL_KIT_3BAR_COUNT_DELAY}, {0x06, EVAL_KIT_3BAR_COUNT_DELAY}, {0x07, EVAL_KIT_3BAR_COUNT_DELAY}, {0x00, EVAL_KIT_3BAR_COUNT_DELAY}
+};
+const ECD_Keyframe keyframes3BarsMidTopBot[] = {
+    {0x02, EVAL_KIT_3BAR_COUNT_DELAY}, {0x06, EVAL_KIT_3BAR_COUNT_DELAY}, {0x07, EVAL_KIT_3BAR_COUNT_DELAY}, {0x00, EVAL_KIT_3BAR_COUNT_DELAY}
 };
 
 void evaluationKitInit(void){
@@ -77,11 +97,29 @@ void evaluationKitInit(void){
     evalKit7BarsConfig.refreshBleachLimitLVoltage   = 0.4;
     evalKit7BarsConfig.bleachingTime                = 1000;
     ecdEvalKit7Bars.setConfig(evalKit7BarsConfig);
+
+    // Measure the Supply Voltage instead of assuming SUPPLY_VOLTAGE
+    evalKitSupply.addDisplay(&ecdEvalKitSingle);
+    evalKitSupply.addDisplay(&ecdEvalKit7SegDot);
+    evalKitSupply.addDisplay(&ecdEvalKit15SegNeg);
+    evalKitSupply.addDisplay(&ecdEvalKit15SegDot);
+    evalKitSupply.addDisplay(&ecdEvalKit3Bars);
+    evalKitSupply.addDisplay(&ecdEvalKit7Bars);
+    evalKitSupply.begin();
+}
+
+/**
+ * Run the kit's background tasks. Call it on every loop().
+ * The Supply Voltage is sampled every SUPPLY_SAMPLE_INTERVAL ms.
+ */
+void evaluationKitPoll(void){
+    evalKitSupply.poll();
 }
 
 
 /**
- * Set the flag to stop the driving of the display
+ * Set the flag to stop the driving of the display.
+ * It stays set, so the Executes left in the animation are skipped until displayCancelAnimation().
  */
 void displayStopAnimation(void){
     p_currentDisplay->setStopDrivingFlag();
@@ -91,6 +129,11 @@ void displayStopAnimation(void){
  * Cancel the current animation and turn off all segments
  */
 void displayCancelAnimation(void){
+    evalKitAnimation.cancel();
+
+    last15SegNegDigits[0] = last15SegNegDigits[1] = FONT_BLANK_DIGIT;
+    last15SegDotDigits[0] = last15SegDotDigits[1] = FONT_BLANK_DIGIT;
+    last7SegDotDigit = FONT_BLANK_DIGIT;
 
     p_currentDisplay->clearStopDriving();
 
@@ -101,8 +144,45 @@ void displayCancelAnimation(void){
 
 }
 
+/**
+ * @brief Move the digits of a display to new values with their transition plans.
+ *
+ * The digits whose plan needs a clear are bleached first, all in the same Execute.
+ * Then one Execute draws every digit, driving only the segments that change.
+ *
+ * @param display display to drive
+ * @param layout layout of the digits
+ * @param lastDigits digit values shown, updated to digits
+ * @param digits new digit values, FONT_BLANK_DIGIT for a blank digit
+ * @param extraMask segments driven apart from the digits (Minus or Dot)
+ * @param extra state of the extra segments
+ */
+static void displayDigitsRun(YNV_ECD & display, const ECD_FontLayout & layout, uint8_t * lastDigits, const uint8_t * digits,
+                             ecdSegmentMask_t extraMask, bool extra){
+    ecdSegmentMask_t frame = display.getFrame();
+    ecdSegmentMask_t clearMask = 0;
+
+    for(uint8_t d = 0; d < layout.numDigits; d++){
+        ECD_TransitionPlan plan = ynvFontDigitTransition(lastDigits[d], digits[d]);
+
+        if(plan.needsClear){
+            clearMask |= ynvFontRenderGlyph(layout, d, plan.bleach);
+        }
+        frame = (frame & ~ynvFontDigitMask(layout, d)) | ynvFontRenderGlyph(layout, d, plan.glyph);
+        lastDigits[d] = digits[d];
+    }
+    frame = extra ? (frame | extraMask) : (frame & ~extraMask);
+
+    if(clearMask != 0){
+        display.setFrame(display.getFrame() & ~clearMask);
+        display.executeDisplay();
+    }
+    display.setFrame(frame);
+    display.executeDisplay();
+}
+
 void display15SegNegInit(void){
-    display15SegNegUpdateTens = true;
+    last15SegNegDigits[0] = last15SegNegDigits[1] = FONT_BLANK_DIGIT;
     ecdEvalKit15SegNeg.setSegmentState(0,  SEGMENT_STATE_BLEACH);
 }
 /**
@@ -110,59 +190,22 @@ void display15SegNegInit(void){
  *
  * This function takes an unsigned integer number and a boolean indicating if the number is negative,
  * and displays the number on a double 7-segment display. The tens and units digits are extracted from
- * the number and displayed on the respective segments of the display.
+ * the number and displayed on the respective segments of the display. Each digit follows its
+ * transition plan from the digit shown before.
  *
  * @param number The unsigned integer number to be displayed (0-99).
  * @param minus A boolean indicating the Minus segment state.
  */
 void display15SegNegRun(unsigned int number, bool minus){
-    unsigned int tensDigit = number / 10;
-    unsigned int unitsDigit = number % 10;
-
-    // Need to check all of this because we don't know if the function call comes from the same sequence or not
-    if( (unitsDigit == 0 && last15SegNumber.unitsDigit == 9 && (tensDigit == last15SegNumber.tensDigit+1 || (last15SegNumber.tensDigit == 9 && tensDigit == 0))) ||          //If the units go from 9 to 0 and the tens increase by 1 or loop back from 9 to 0, the sequence is ascending and the tens need to refresh.
-        (unitsDigit == 9 && last15SegNumber.unitsDigit == 0 && (tensDigit == last15SegNumber.tensDigit-1 || (last15SegNumber.tensDigit == 0 && tensDigit == 9))) )           //If the units go from 0 to 9 and the tens decrease by 1 or loop back from 0 to 9, the sequence is descending and the tens need to refresh.
-        {
-            display15SegNegUpdateTens = true;
-        }
+    const uint8_t digits[2] = {(uint8_t)((number / 10) % 10), (uint8_t)(number % 10)};
 
     p_currentDisplay = &ecdEvalKit15SegNeg;
 
-    EK_15Seg_Struct_t displayMask {};
-    
-    displayMask.extra = minus;
-    displayMask.tens = (bool*)mask7SegDotsDisplay[tensDigit];
-    displayMask.units = (bool*)mask7SegDotsDisplay[unitsDigit];
-
-    // Set Tens number Segments
-    for (int i = 0; i < 7; ++i) {
-        if(display15SegNegUpdateTens){
-            ecdEvalKit15SegNeg.setSegmentState(i+1, SEGMENT_STATE_BLEACH);
-        }
-        ecdEvalKit15SegNeg.setSegmentState(i+8, SEGMENT_STATE_BLEACH);
-    }
-    ecdEvalKit15SegNeg.executeDisplay();
-    
-    // Set Extra Segment
-    ecdEvalKit15SegNeg.setSegmentState(0,  displayMask.extra);
-
-    for (int i = 0; i < 7; ++i) {
-        if(display15SegNegUpdateTens){
-            ecdEvalKit15SegNeg.setSegmentState(i+1, displayMask.tens[i]);
-        }
-        ecdEvalKit15SegNeg.setSegmentState(i+8, displayMask.units[i]);
-    }
-
-    //Execute Display
-    ecdEvalKit15SegNeg.executeDisplay();
-    
-    last15SegNumber.tensDigit = tensDigit;
-    last15SegNumber.unitsDigit = unitsDigit;
-    display15SegNegUpdateTens = false;
+    displayDigitsRun(ecdEvalKit15SegNeg, font15SegLayout, last15SegNegDigits, digits, 1, minus);
 }
 
 void display15SegDotInit(void){
-    display15SegDotUpdateTens = true;
+    last15SegDotDigits[0] = last15SegDotDigits[1] = FONT_BLANK_DIGIT;
     ecdEvalKit15SegDot.setSegmentState(0,  SEGMENT_STATE_BLEACH);
 }
 
@@ -172,56 +215,17 @@ void display15SegDotInit(void){
  * This function takes an unsigned integer number and a boolean indicating if the number is negative,
  * and displays the number on a double 7-segment display. The tens and units digits are extracted from
  * the number and displayed on the respective segments of the display. A dot is displayed in the middle
- * of the display.
+ * of the display. Each digit follows its transition plan from the digit shown before.
  *
  * @param number The unsigned integer number to be displayed (0-99).
  * @param dot A boolean indicating the Dot segment state.
  */
 void display15SegDotRun(unsigned int number, bool dot){
-    unsigned int tensDigit = number / 10;
-    unsigned int unitsDigit = number % 10;
-    
-    // Need to check all of this because we don't know if the function call comes from the same sequence or not
-    if( (unitsDigit == 0 && last15SegNumber.unitsDigit == 9 && (tensDigit == last15SegNumber.tensDigit+1 || (last15SegNumber.tensDigit == 9 && tensDigit == 0))) ||          //If the units go from 9 to 0 and the tens increase by 1 or loop back from 9 to 0, the sequence is ascending and the tens need to refresh.
-        (unitsDigit == 9 && last15SegNumber.unitsDigit == 0 && (tensDigit == last15SegNumber.tensDigit-1 || (last15SegNumber.tensDigit == 0 && tensDigit == 9))) )           //If the units go from 0 to 9 and the tens decrease by 1 or loop back from 0 to 9, the sequence is descending and the tens need to refresh.
-        {
-            display15SegDotUpdateTens = true;
-        }
-    
-    p_currentDisplay = &ecdEvalKit15SegDot;
+    const uint8_t digits[2] = {(uint8_t)((number / 10) % 10), (uint8_t)(number % 10)};
 
-    EK_15Seg_Struct_t displayMask {};
-    
-    displayMask.extra = dot;
-    displayMask.tens = (bool*)mask7SegDotsDisplay[tensDigit];
-    displayMask.units = (bool*)mask7SegDotsDisplay[unitsDigit];
-    
-    
-    // Set Tens number Segments
-    for (int i = 0; i < 7; ++i) {
-        if(display15SegDotUpdateTens){
-            ecdEvalKit15SegDot.setSegmentState(i+1, SEGMENT_STATE_BLEACH);
-        }
-        ecdEvalKit15SegDot.setSegmentState(i+8, SEGMENT_STATE_BLEACH);
-    }
-    ecdEvalKit15SegDot.executeDisplay();
-    
-    // Set Extra Segment
-    ecdEvalKit15SegDot.setSegmentState(0,  displayMask.extra);
-
-    for (int i = 0; i < 7; ++i) {
-        if(display15SegDotUpdateTens){
-            ecdEvalKit15SegDot.setSegmentState(i+1, displayMask.tens[i]);
-        }
-        ecdEvalKit15SegDot.setSegmentState(i+8, displayMask.units[i]);
-    }
+    p_currentDisplay = &ecdEvalKit15SegDot;
 
-    //Execute Display
-    ecdEvalKit15SegDot.executeDisplay();
-    
-    last15SegNumber.tensDigit = tensDigit;
-    last15SegNumber.unitsDigit = unitsDigit;
-    display15SegDotUpdateTens = false;
+    displayDigitsRun(ecdEvalKit15SegDot, font15SegLayout, last15SegDotDigits, digits, 1, dot);
 }
 
 /**
@@ -241,29 +245,13 @@ void displaySingleSet(bool state){
  * @param number The number to be displayed.
  */
 void display7SegDotRun(unsigned int number, bool dot){
-    uint8_t mask_iterator = 0;
-    p_currentDisplay = &ecdEvalKit7SegDot;
+    const ecdSegmentMask_t dotMask = ynvFontRenderGlyph(font7SegDotLayout, 0, FONT_SEG_DP);
+    // "10" (FONT_BLANK_DIGIT) renders all OFF, higher numbers keep the digit and only set the Dot
+    const uint8_t digit = (number < EVAL_KIT_7SEG_DOT_MASK_NUM_OF_ANIMATIONS) ? number : last7SegDotDigit;
 
+    p_currentDisplay = &ecdEvalKit7SegDot;
 
-    if(number < EVAL_KIT_7SEG_DOT_MASK_NUM_OF_ANIMATIONS){
-        for (int i = 0; i < EVAL_KIT_7SEG_DOT_NUM_SEGMENTS; ++i) {
-            if(i != 3){
-                ecdEvalKit7SegDot.setSegmentState(i, 0);
-            }
-        }
-        
-        ecdEvalKit7SegDot.executeDisplay();
-
-        for (int i = 0; i < EVAL_KIT_7SEG_DOT_NUM_SEGMENTS; ++i) {
-            if(i != 3){
-                ecdEvalKit7SegDot.setSegmentState(i, mask7SegDotsDisplay[number][mask_iterator]);
-                mask_iterator++;
-            }
-        }
-    }
-    ecdEvalKit7SegDot.setSegmentState(3, dot);
-    
-    ecdEvalKit7SegDot.executeDisplay();
+    displayDigitsRun(ecdEvalKit7SegDot, font7SegDotLayout, &last7SegDotDigit, &digit, dotMask, dot);
 }
 
 /**
@@ -314,31 +302,120 @@ void display3BarsClear(void){
     ecdEvalKit3Bars.executeDisplay();
 }
 
+/**
+ * @brief Drive or release one staggered group of the direct drive pins.
+ * @param group The group, segment i belongs to group i % groups.
+ * @param groups The number of groups.
+ * @param drive true to drive the pins with state, false to set them to High-Impedance.
+ * @param state The state of the segments.
+ */
+static void displayDirectDriveGroup(int group, int groups, bool drive, bool state){
+    for (int i = group; i < EVAL_KIT_15SEG_NEGATIVE_NUM_SEGMENTS; i += groups)
+    {
+        if(drive){
+            pinMode(evalKit15SegNegPinList[i], OUTPUT);
+            digitalWrite(evalKit15SegNegPinList[i], state);
+        }
+        else{
+            pinMode(evalKit15SegNegPinList[i], INPUT);
+        }
+    }
+}
+
 /**
  * @brief Direct drive all pins of a display.
+ * The pins are split in the display's ECD_Config.driveGroups staggered groups, each one driven for driveTime.
  * @param state The state of the segments.
  * @param driveTime The time to drive the segments.
  */
 void displayDirectSetAll(bool state, uint16_t driveTime){
+    const ECD_Config & config = ecdEvalKit15SegNeg.getConfig();
+    int groups = constrain(config.driveGroups, 1, ECD_MAX_DRIVE_GROUPS);
+    int started = 0;
+    int released = 0;
+
     p_currentDisplay = &ecdEvalKit15SegNeg;
 
     pinMode(PIN_CE, OUTPUT);
     analogWrite(PIN_CE, ADC_DAC_MAX_LSB/2);
     delay(50);
 
-    for (int i = 0; i < EVAL_KIT_15SEG_NEGATIVE_NUM_SEGMENTS; i++)
+    unsigned long startTime = millis();
+    while (released < groups)
     {
-        pinMode(evalKit15SegNegPinList[i], OUTPUT);
-        digitalWrite(evalKit15SegNegPinList[i], state);
-    }
-
-    delay(driveTime);
+        unsigned long elapsed = millis() - startTime;
 
-    for (int i = 0; i < EVAL_KIT_15SEG_NEGATIVE_NUM_SEGMENTS; i++)
-    {
-        pinMode(evalKit15SegNegPinList[i], INPUT);
+        while (started < groups && elapsed >= (unsigned long)started * config.driveGroupStagger)
+        {
+            displayDirectDriveGroup(started++, groups, true, state);
+        }
+        while (released < started && elapsed >= (unsigned long)released * config.driveGroupStagger + driveTime)
+        {
+            displayDirectDriveGroup(released++, groups, false, state);
+        }
     }
     
     analogWrite(PIN_CE, 0);
     delay(10);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Start a keyframe animation without blocking. Call displayAnimationTick() until it returns true.
+ * @param animation The animation to start, one of evaluationKitAnimations_e.
+ * @return false if the animation isn't keyframe based.
+ */
+bool displayAnimationStart(unsigned int animation){
+    YNV_ECD * display;
+    const ECD_Keyframe * keyframes;
+    uint16_t numKeyframes;
+
+    switch(animation){
+        case EVAL_ANIMATION_7BARS_COUNT_UP:
+            display = &ecdEvalKit7Bars;
+            keyframes = keyframes7BarsCountUp;
+            numKeyframes = sizeof(keyframes7BarsCountUp) / sizeof(ECD_Keyframe);
+        break;
+        case EVAL_ANIMATION_7BARS_COUNT_DOWN:
+            display = &ecdEvalKit7Bars;
+            keyframes = keyframes7BarsCountDown;
+            numKeyframes = sizeof(keyframes7BarsCountDown) / sizeof(ECD_Keyframe);
+        break;
+        case EVAL_ANIMATION_3BARS_COUNT_UP:
+            display = &ecdEvalKit3Bars;
+            keyframes = keyframes3BarsCountUp;
+            numKeyframes = sizeof(keyframes3BarsCountUp) / sizeof(ECD_Keyframe);
+        break;
+        case EVAL_ANIMATION_3BARS_COUNT_DOWN:
+            display = &ecdEvalKit3Bars;
+            keyframes = keyframes3BarsCountDown;
+            numKeyframes = sizeof(keyframes3BarsCountDown) / sizeof(ECD_Keyframe);
+        break;
+        case EVAL_ANIMATION_3BARS_MID_TOP_BOT:
+            display = &ecdEvalKit3Bars;
+            keyframes = keyframes3BarsMidTopBot;
+            numKeyframes = sizeof(keyframes3BarsMidTopBot) / sizeof(ECD_Keyframe);
+        break;
+        default:
+            return false;
+    }
+
+    p_currentDisplay = display;
+    return evalKitAnimation.begin(*display, keyframes, numKeyframes);
+}
+
+/**
+ * @brief Run the keyframe animation started with displayAnimationStart().
+ * @return true when the animation is finished or canceled.
+ */
+bool displayAnimationTick(void){
+    return evalKitAnimation.tick(millis());
+}
+
+/**
+ * @brief Pause or resume the keyframe animation. Keep calling displayAnimationTick() while paused:
+ * the running Execute is finished and the display holds before the next keyframe.
+ * @param paused true to pause, false to resume
+ */
+void displayAnimationPause(bool paused){
+    evalKitAnimation.pause(paused);
+}
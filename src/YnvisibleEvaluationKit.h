@@ -1,6 +1,8 @@
 #ifndef _YNVISIBLE_EVAL_KIT_
 #define _YNVISIBLE_EVAL_KIT_
 #include "YnvisibleECD.h"
+#include "YnvisibleAnimation.h"
+#include "YnvisibleSupply.h"
 
 #define EVAL_KIT_SINGLE_NUM_SEGMENTS                1
 #define EVAL_KIT_SINGLE_PIN_LIST                    {PIN_SEG_1}
@@ -75,6 +77,7 @@ struct EK_15Seg_Values_t{
 };
 
 void evaluationKitInit(void);
+void evaluationKitPoll(void);
 void displayStopAnimation(void);
 void displayCancelAnimation(void);
 
@@ -95,4 +98,8 @@ void display3BarsClear(void);
 
 void displayDirectSetAll(bool state, uint16_t driveTime);
 
+bool displayAnimationStart(unsigned int animation);
+bool displayAnimationTick(void);
+void displayAnimationPause(bool paused);
+
 #endif  // _YNVISIBLE_DRIVER5_EVALUATION
\ No newline at end of file
@@ -0,0 +1,207 @@
+/**
+ * 7-Segment font for Ynvisible Electrochromic Displays
+ *
+ * Glyphs are packed one byte per character and kept in flash. A layout maps the
+ * glyph bits of every digit onto the segment indexes of a display, so the same
+ * code renders text and numbers on any of the 7-Segment based displays.
+ */
+#include "Arduino.h"
+#include "YnvisibleFont.h"
+
+#define FONT_FIRST_CHAR     ' '
+#define FONT_LAST_CHAR      '_'
+
+/**
+ * Font Table
+ * One glyph per character, from ' ' (0x20) to '_' (0x5F).
+ * Bit 0 = segment A ... bit 6 = segment G
+ */
+static constexpr ynvGlyph_t fontTable[FONT_LAST_CHAR - FONT_FIRST_CHAR + 1] PROGMEM = {
+  0x00, 0x00, 0x22, 0x00, 0x00, 0x00, 0x00, 0x02,   //   ! " # $ % & '
+  0x39, 0x0F, 0x00, 0x00, 0x00, 0x40, 0x00, 0x52,   // ( ) * + , - . /
+  0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07,   // 0 1 2 3 4 5 6 7
+  0x7F, 0x6F, 0x00, 0x00, 0x00, 0x48, 0x00, 0x53,   // 8 9 : ; < = > ?
+  0x00, 0x77, 0x7C, 0x39, 0x5E, 0x79, 0x71, 0x3D,   // @ A b C d E F G
+  0x76, 0x30, 0x1E, 0x00, 0x38, 0x00, 0x54, 0x3F,   // H I J K L M n O
+  0x73, 0x67, 0x50, 0x6D, 0x78, 0x3E, 0x00, 0x00,   // P q r S t U V W
+  0x00, 0x6E, 0x5B, 0x39, 0x64, 0x0F, 0x23, 0x08    // X y Z [ \ ] ^ _
+};
+
+/**
+ * Decimal digit glyphs read from the Font Table at compile time, blank from FONT_BLANK_DIGIT
+ */
+static constexpr ynvGlyph_t fontDigitGlyph(unsigned int t_digit){
+  return (t_digit < FONT_BLANK_DIGIT) ? fontTable['0' - FONT_FIRST_CHAR + t_digit] : 0;
+}
+
+#define FONT_PLAN(from, to)   ynvFontTransition(fontDigitGlyph(from), fontDigitGlyph(to))
+#define FONT_PLAN_ROW(from)   { FONT_PLAN(from, 0), FONT_PLAN(from, 1), FONT_PLAN(from, 2), FONT_PLAN(from, 3), \
+                                FONT_PLAN(from, 4), FONT_PLAN(from, 5), FONT_PLAN(from, 6), FONT_PLAN(from, 7), \
+                                FONT_PLAN(from, 8), FONT_PLAN(from, 9), FONT_PLAN(from, FONT_BLANK_DIGIT) }
+
+/**
+ * Transition Plans Table
+ * One plan per pair of digit values, [from][to]. Built by the compiler from the Font Table.
+ */
+static constexpr ECD_TransitionPlan fontDigitPlans[FONT_PLAN_DIGITS][FONT_PLAN_DIGITS] PROGMEM = {
+  FONT_PLAN_ROW(0), FONT_PLAN_ROW(1), FONT_PLAN_ROW(2), FONT_PLAN_ROW(3), FONT_PLAN_ROW(4), FONT_PLAN_ROW(5),
+  FONT_PLAN_ROW(6), FONT_PLAN_ROW(7), FONT_PLAN_ROW(8), FONT_PLAN_ROW(9), FONT_PLAN_ROW(FONT_BLANK_DIGIT)
+};
+
+static_assert(fontDigitPlans[0][1].needsClear == false && fontDigitPlans[0][1].bleach == (FONT_SEG_A | FONT_SEG_D | FONT_SEG_E | FONT_SEG_F),
+              "0 -> 1 only bleaches");
+static_assert(fontDigitPlans[9][0].needsClear == true && fontDigitPlans[9][0].color == fontDigitGlyph(0), "9 -> 0 is redrawn");
+static_assert(fontDigitPlans[FONT_BLANK_DIGIT][8].color == fontDigitGlyph(8), "A blank digit is drawn without a clear");
+
+/**
+ * @brief Transition plan between two digit values
+ *
+ * @param t_from digit shown, FONT_BLANK_DIGIT or higher for a blank digit
+ * @param t_to new digit, FONT_BLANK_DIGIT or higher for a blank digit
+ * @return plan from the Transition Plans Table
+ */
+ECD_TransitionPlan ynvFontDigitTransition(unsigned int t_from, unsigned int t_to){
+  if(t_from > FONT_BLANK_DIGIT){
+    t_from = FONT_BLANK_DIGIT;
+  }
+  if(t_to > FONT_BLANK_DIGIT){
+    t_to = FONT_BLANK_DIGIT;
+  }
+
+  const ECD_TransitionPlan * plan = &fontDigitPlans[t_from][t_to];
+  ECD_TransitionPlan result;
+
+  result.bleach = pgm_read_byte(&plan->bleach);
+  result.color = pgm_read_byte(&plan->color);
+  result.glyph = pgm_read_byte(&plan->glyph);
+  result.needsClear = pgm_read_byte(&plan->needsClear) != 0;
+  return result;
+}
+
+/**
+ * @brief Glyph for a character
+ *
+ * @param t_char character
+ * @return glyph, blank for unsupported characters
+ */
+ynvGlyph_t ynvFontGlyph(char t_char){
+  if(t_char >= 'a' && t_char <= 'z'){
+    t_char -= 'a' - 'A';
+  }
+  if(t_char < FONT_FIRST_CHAR || t_char > FONT_LAST_CHAR){
+    return 0;
+  }
+  return pgm_read_byte(&fontTable[t_char - FONT_FIRST_CHAR]);
+}
+
+/**
+ * @brief Glyph for a digit value
+ *
+ * @param t_digit value (0-15)
+ * @return glyph, blank for values above 15
+ */
+ynvGlyph_t ynvFontDigit(unsigned int t_digit){
+  if(t_digit > 15){
+    return 0;
+  }
+  return ynvFontGlyph(t_digit < 10 ? '0' + t_digit : 'A' + (t_digit - 10));
+}
+
+/**
+ * @brief Segments lit by a glyph on one digit of a layout
+ *
+ * @param t_layout display layout
+ * @param t_digit digit position, 0 is the leftmost
+ * @param t_glyph glyph to render
+ * @return segment mask, empty if the digit is out of the layout
+ */
+ecdSegmentMask_t ynvFontRenderGlyph(const ECD_FontLayout & t_layout, uint8_t t_digit, ynvGlyph_t t_glyph){
+  ecdSegmentMask_t mask = 0;
+
+  if(t_digit >= t_layout.numDigits){
+    return 0;
+  }
+
+  const int8_t * map = &t_layout.segmentMap[t_digit * FONT_GLYPH_BITS];
+  for(int i = 0; i < FONT_GLYPH_BITS; i++){
+    if((t_glyph & (1 << i)) && map[i] != FONT_NO_SEGMENT){
+      mask |= (ecdSegmentMask_t)1 << map[i];
+    }
+  }
+  return mask;
+}
+
+/**
+ * @brief All the segments used by one digit of a layout
+ *
+ * @param t_layout display layout
+ * @param t_digit digit position, 0 is the leftmost
+ */
+ecdSegmentMask_t ynvFontDigitMask(const ECD_FontLayout & t_layout, uint8_t t_digit){
+  return ynvFontRenderGlyph(t_layout, t_digit, 0xFF);
+}
+
+/**
+ * @brief Render a string from the leftmost digit
+ *
+ * @param t_layout display layout
+ * @param t_text null terminated string. A '.' lights the Dot of the previous digit.
+ * @return segment mask
+ */
+ecdSegmentMask_t ynvFontRenderText(const ECD_FontLayout & t_layout, const char * t_text){
+  ecdSegmentMask_t mask = 0;
+  int digit = 0;
+
+  for(; *t_text != '\0'; t_text++){
+    if(*t_text == '.' && digit > 0){
+      mask |= ynvFontRenderGlyph(t_layout, digit-1, FONT_SEG_DP);
+      continue;
+    }
+    if(digit >= t_layout.numDigits){
+      break;
+    }
+    mask |= ynvFontRenderGlyph(t_layout, digit, ynvFontGlyph(*t_text));
+    digit++;
+  }
+  return mask;
+}
+
+/**
+ * @brief Render a number aligned to the rightmost digit
+ *
+ * @param t_layout display layout
+ * @param t_number number to render
+ * @param t_base numeric base (2-16)
+ * @return segment mask. Numbers that don't fit are rendered as dashes.
+ */
+ecdSegmentMask_t ynvFontRenderNumber(const ECD_FontLayout & t_layout, long t_number, uint8_t t_base){
+  ecdSegmentMask_t mask = 0;
+  bool negative = t_number < 0;
+  unsigned long value = negative ? 0UL - (unsigned long)t_number : (unsigned long)t_number;
+  int digit = t_layout.numDigits - 1;
+
+  if(t_base < 2 || t_base > 16){
+    t_base = 10;
+  }
+
+  do{
+    if(digit < 0){
+      break;
+    }
+    mask |= ynvFontRenderGlyph(t_layout, digit, ynvFontDigit(value % t_base));
+    value /= t_base;
+    digit--;
+  }while(value != 0);
+
+  if(negative && digit >= 0){
+    mask |= ynvFontRenderGlyph(t_layout, digit, FONT_SEG_G);
+  }
+  else if(value != 0 || negative){
+    // Doesn't fit
+    mask = 0;
+    for(int i = 0; i < t_layout.numDigits; i++){
+      mask |= ynvFontRenderGlyph(t_layout, i, FONT_SEG_G);
+    }
+  }
+  return mask;
+}
@@ -0,0 +1,105 @@
+/*
+	YnvisibleFont.h - 7-Segment font for Ynvisible's Electrochromic Displays
+	For Driver 5.x Hardware
+*/
+
+#ifndef _YNVISIBLE_FONT
+#define _YNVISIBLE_FONT
+
+#include "Arduino.h"
+#include "YnvisibleECD.h"
+
+// Glyph bits, one per segment of a 7-Segment digit
+#define FONT_SEG_A				0x01		// Top
+#define FONT_SEG_B				0x02		// Top Right
+#define FONT_SEG_C				0x04		// Bottom Right
+#define FONT_SEG_D				0x08		// Bottom
+#define FONT_SEG_E				0x10		// Bottom Left
+#define FONT_SEG_F				0x20		// Top Left
+#define FONT_SEG_G				0x40		// Middle
+#define FONT_SEG_DP				0x80		// Dot
+
+#define FONT_GLYPH_BITS			8				// Entries per digit in a layout segment map
+#define FONT_NO_SEGMENT			-1			// Glyph bit not wired on this layout
+#define FONT_BLANK_DIGIT		10			// Digit value of a blank digit, see ynvFontDigitTransition()
+#define FONT_PLAN_DIGITS		11			// Decimal digits and the blank digit
+
+typedef uint8_t ynvGlyph_t;				// Bit 0 = segment A ... bit 6 = segment G, bit 7 = Dot
+
+/**
+ * Maps the glyph bits of each digit onto the segments of a display.
+ * segmentMap holds FONT_GLYPH_BITS entries per digit, digit 0 is the leftmost one.
+ * Each entry is the segment index in the display pin list, or FONT_NO_SEGMENT.
+ */
+struct ECD_FontLayout{
+	const int8_t * segmentMap;
+	uint8_t numDigits;
+};
+
+/**
+ * Pulses to change one digit from a glyph to another.
+ * Without a clear, one Execute bleaches and colors the bits that differ. With a clear the
+ * old glyph is bleached first, in its own Execute, and the new glyph is colored after it,
+ * so its segments all get the same fresh pulse.
+ */
+struct ECD_TransitionPlan{
+	ynvGlyph_t 	bleach;				// Glyph bits to bleach, the whole old glyph with a clear
+	ynvGlyph_t 	color;				// Glyph bits to color, the whole new glyph with a clear
+	ynvGlyph_t 	glyph;				// Glyph shown at the end
+	bool 				needsClear;		// Bleach the digit before drawing the new glyph
+};
+
+/**
+ * Transition plan between two glyphs. A clear is needed when the new glyph keeps
+ * segments of the old one and adds others: the kept segments would show an older,
+ * partly decayed color next to the new ones.
+ */
+constexpr ECD_TransitionPlan ynvFontTransition(ynvGlyph_t t_from, ynvGlyph_t t_to){
+	return ((t_from & t_to) != 0 && (t_to & ~t_from) != 0) ?
+		ECD_TransitionPlan{ t_from, t_to, t_to, true } :
+		ECD_TransitionPlan{ (ynvGlyph_t)(t_from & ~t_to), (ynvGlyph_t)(t_to & ~t_from), t_to, false };
+}
+
+/**
+ * Transition plan between two digit values, from a table built at compile time.
+ * @param t_from digit shown (0-9), FONT_BLANK_DIGIT or higher for a blank digit
+ * @param t_to new digit (0-9), FONT_BLANK_DIGIT or higher for a blank digit
+ */
+ECD_TransitionPlan ynvFontDigitTransition(unsigned int t_from, unsigned int t_to);
+
+/**
+ * Glyph for a character. Digits, hex and a minimal alphabet are supported,
+ * lowercase is folded to uppercase. Unsupported characters are blank.
+ */
+ynvGlyph_t ynvFontGlyph(char t_char);
+
+/**
+ * Glyph for a digit value
+ * @param t_digit value (0-15), higher values are blank
+ */
+ynvGlyph_t ynvFontDigit(unsigned int t_digit);
+
+/**
+ * Segments of a display lit by a glyph on one digit of a layout
+ */
+ecdSegmentMask_t ynvFontRenderGlyph(const ECD_FontLayout & t_layout, uint8_t t_digit, ynvGlyph_t t_glyph);
+
+/**
+ * All the segments used by one digit of a layout
+ */
+ecdSegmentMask_t ynvFontDigitMask(const ECD_FontLayout & t_layout, uint8_t t_digit);
+
+/**
+ * Render a string from the leftmost digit. A '.' lights the Dot of the previous digit.
+ * Characters past the last digit are ignored.
+ */
+ecdSegmentMask_t ynvFontRenderText(const ECD_FontLayout & t_layout, const char * t_text);
+
+/**
+ * Render a number aligned to the rightmost digit, with a '-' in front when negative.
+ * Numbers that do not fit are shown as dashes on every digit.
+ * @param t_base 2-16
+ */
+ecdSegmentMask_t ynvFontRenderNumber(const ECD_FontLayout & t_layout, long t_number, uint8_t t_base = 10);
+
+#endif	// _YNVISIBLE_FONT
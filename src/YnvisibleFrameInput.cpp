@@ -0,0 +1,203 @@
+/**
+ * Segment frames streamed from a host over Serial/USB
+ *
+ * A host (PC, Raspberry Pi, another board) sends one small binary frame per display
+ * update, see YnvisibleFrameInput.h for the format. Each frame is applied with
+ * YNV_ECD.setFrame() and YNV_ECD.beginExecute(), so only the changed segments are driven.
+ */
+#include "Arduino.h"
+#include "YnvisibleFrameInput.h"
+
+/**
+ * @brief Encode a frame, e.g. to send it to another board
+ *
+ * The mask uses as few bytes as the frame needs.
+ *
+ * @param t_buffer output, must hold FRAME_MAX_SIZE bytes
+ * @param t_display Display ID, 0 - 15
+ * @param t_frame segments in the Color state
+ * @param t_holdTime ms - 0 for no Hold Time
+ * @return number of bytes written
+ */
+uint8_t ynvFrameEncode(uint8_t * t_buffer, uint8_t t_display, ecdSegmentMask_t t_frame, uint16_t t_holdTime){
+  uint8_t maskBytes = 1;
+  uint8_t length = 0;
+  uint8_t checkSum = 0;
+
+  while(maskBytes < 4 && (t_frame >> (8 * maskBytes)) != 0){
+    maskBytes++;
+  }
+
+  t_buffer[length++] = FRAME_SYNC;
+  t_buffer[length++] = (t_display & FRAME_HEADER_ID_MASK) | ((t_holdTime != 0) ? FRAME_HEADER_HOLD : 0) |
+                       ((maskBytes - 1) << FRAME_HEADER_SIZE_SHIFT);
+  for(uint8_t i = 0; i < maskBytes; i++){
+    t_buffer[length++] = (t_frame >> (8 * i)) & 0xFF;
+  }
+  if(t_holdTime != 0){
+    t_buffer[length++] = t_holdTime & 0xFF;
+    t_buffer[length++] = t_holdTime >> 8;
+  }
+
+  for(uint8_t i = 1; i < length; i++){
+    checkSum += t_buffer[i];
+  }
+  t_buffer[length++] = checkSum;
+  return length;
+}
+
+/**
+ * @brief Add a display to drive from the stream
+ *
+ * @param t_display display, must stay valid while the receiver is used
+ * @return false if the receiver is full
+ */
+bool YNV_FRAME_RECEIVER::addDisplay(YNV_ECD_BASE * t_display){
+  if(t_display == nullptr || m_numberOfDisplays >= FRAME_MAX_DISPLAYS){
+    return false;
+  }
+  m_displays[m_numberOfDisplays] = t_display;
+  m_numberOfDisplays++;
+  return true;
+}
+
+/**
+ * @brief Parse one byte of the stream
+ *
+ * A frame with a bad Checksum or an unknown Display ID is dropped, and the parser
+ * looks for the next Sync byte.
+ *
+ * @param t_byte next byte received
+ * @return true if a valid frame was just queued
+ */
+bool YNV_FRAME_RECEIVER::feed(uint8_t t_byte){
+  switch(m_state){
+    case FRAME_PARSER_WAIT_SYNC:
+      if(t_byte == FRAME_SYNC){
+        m_state = FRAME_PARSER_HEADER;
+      }
+    break;
+
+    case FRAME_PARSER_HEADER:
+      m_header = t_byte;
+      m_checkSum = t_byte;
+      m_frame.display = t_byte & FRAME_HEADER_ID_MASK;
+      m_frame.frame = 0;
+      m_frame.holdTime = 0;
+      m_maskBytes = ((t_byte >> FRAME_HEADER_SIZE_SHIFT) & 0x03) + 1;
+      m_maskIndex = 0;
+      m_state = FRAME_PARSER_MASK;
+    break;
+
+    case FRAME_PARSER_MASK:
+      m_checkSum += t_byte;
+      m_frame.frame |= (ecdSegmentMask_t)t_byte << (8 * m_maskIndex);
+      m_maskIndex++;
+      if(m_maskIndex >= m_maskBytes){
+        m_state = (m_header & FRAME_HEADER_HOLD) ? FRAME_PARSER_HOLD_LSB : FRAME_PARSER_CHECKSUM;
+      }
+    break;
+
+    case FRAME_PARSER_HOLD_LSB:
+      m_checkSum += t_byte;
+      m_frame.holdTime = t_byte;
+      m_state = FRAME_PARSER_HOLD_MSB;
+    break;
+
+    case FRAME_PARSER_HOLD_MSB:
+      m_checkSum += t_byte;
+      m_frame.holdTime |= (uint16_t)t_byte << 8;
+      m_state = FRAME_PARSER_CHECKSUM;
+    break;
+
+    case FRAME_PARSER_CHECKSUM:
+      m_state = FRAME_PARSER_WAIT_SYNC;
+      if(t_byte != m_checkSum || m_frame.display >= m_numberOfDisplays){
+        m_errorCount++;
+        return false;
+      }
+      return m_queue.push(m_frame);
+  }
+  return false;
+}
+
+/**
+ * @brief Read the stream and drive the displays
+ *
+ * Call it from loop(). Each display starts the latest frame received for it once its
+ * last Execute is done and its Hold Time is over.
+ *
+ * @param t_now ms - current time, usually millis()
+ * @return true if no frame is waiting and no display is driving
+ */
+bool YNV_FRAME_RECEIVER::update(unsigned long t_now){
+  bool idle = true;
+
+  if(m_stream != nullptr){
+    for(int i = 0; i < FRAME_MAX_BYTES_PER_POLL && m_stream->available() > 0; i++){
+      feed(m_stream->read());
+    }
+  }
+  queuePending();
+
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    if(updateDisplay(d, t_now) == false){
+      idle = false;
+    }
+  }
+  return idle && m_pendingMask == 0;
+}
+
+/**
+ * @brief Move the parsed frames to the pending frame of their display
+ *
+ * A frame still pending is replaced by the newer one.
+ */
+void YNV_FRAME_RECEIVER::queuePending(void){
+  ECD_Frame frame;
+
+  while(m_queue.pop(frame)){
+    uint8_t displayBit = 1 << frame.display;
+
+    if(m_pendingMask & displayBit){
+      m_coalescedCount++;
+    }
+    m_pending[frame.display] = frame;
+    m_pendingMask |= displayBit;
+  }
+}
+
+/**
+ * @brief Advance a display and start its pending frame when it's free
+ *
+ * @param t_display Display ID
+ * @param t_now ms - current time
+ * @return true if the display is idle
+ */
+bool YNV_FRAME_RECEIVER::updateDisplay(int t_display, unsigned long t_now){
+  YNV_ECD_BASE * display = m_displays[t_display];
+  uint8_t displayBit = 1 << t_display;
+
+  if(display->update(t_now) == false){
+    return false;
+  }
+  if((m_holdMask & displayBit) && (t_now - m_holdStart[t_display]) < m_holdTime[t_display]){
+    return true;
+  }
+  m_holdMask &= ~displayBit;
+
+  if((m_pendingMask & displayBit) == 0){
+    return true;
+  }
+  m_pendingMask &= ~displayBit;
+
+  display->setFrame(m_pending[t_display].frame);
+  display->beginExecute();
+  m_frameCount++;
+  if(m_pending[t_display].holdTime != 0){
+    m_holdStart[t_display] = t_now;
+    m_holdTime[t_display] = m_pending[t_display].holdTime;
+    m_holdMask |= displayBit;
+  }
+  return display->isBusy() == false;
+}
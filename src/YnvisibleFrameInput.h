@@ -0,0 +1,120 @@
+/*
+	YnvisibleFrameInput.h - Segment frames streamed from a host over Serial/USB
+	For Driver 5.x Hardware
+*/
+
+#ifndef _YNVISIBLE_FRAME_INPUT
+#define _YNVISIBLE_FRAME_INPUT
+
+#include "Arduino.h"
+#include "YnvisibleECD.h"
+#include "YnvisibleQueue.h"
+
+#define FRAME_MAX_DISPLAYS				8
+#define FRAME_QUEUE_SIZE					16			// Parsed frames waiting for update(), a power of two
+#define FRAME_MAX_BYTES_PER_POLL	64			// Bytes read from the stream on each update(), so a busy line can't stall the loop
+
+/**
+ * Binary frame, 4 to 9 bytes
+ * ------------------------------------------------------------------------------
+ * |  Byte    |     Name            |   Value                                   |
+ * |----------|---------------------------------------------------------------- |
+ * | Byte 0   | Sync                |    [0xA5]                                 |
+ * | Byte 1   | Header              |    bits 0-3: Display ID                   |
+ * |          |                     |    bit 4:    a Hold Time follows the mask |
+ * |          |                     |    bits 5-6: mask bytes - 1               |
+ * | Byte 2   | Segment Mask        |    1 to 4 bytes, LSB first. Bit i = seg i |
+ * | ...      | Hold Time           |    optional, 2 bytes LSB first, ms        |
+ * | Byte n   | Checksum            |    sum of Bytes 1 to n-1, 8 bit           |
+ * ------------------------------------------------------------------------------
+ * The Display ID is the position given by YNV_FRAME_RECEIVER.addDisplay().
+ * The Hold Time is the shortest time the frame stays on the display before the next
+ * frame for it is executed, counted from the start of its Execute.
+ */
+#define FRAME_SYNC 								0xA5
+#define FRAME_HEADER_ID_MASK 			0x0F
+#define FRAME_HEADER_HOLD 				0x10
+#define FRAME_HEADER_SIZE_SHIFT 	5
+#define FRAME_MAX_SIZE 						9				// Sync + Header + 4 Mask bytes + 2 Hold Time bytes + Checksum
+
+enum ecdFrameParserState_e{
+	FRAME_PARSER_WAIT_SYNC = 0,
+	FRAME_PARSER_HEADER,
+	FRAME_PARSER_MASK,
+	FRAME_PARSER_HOLD_LSB,
+	FRAME_PARSER_HOLD_MSB,
+	FRAME_PARSER_CHECKSUM
+};
+
+/**
+ * One frame received for a display
+ */
+struct ECD_Frame{
+	uint8_t 					display;
+	ecdSegmentMask_t 	frame;					// Segments in the Color state, see YNV_ECD.setFrame()
+	uint16_t 					holdTime;				// ms
+};
+
+uint8_t ynvFrameEncode(uint8_t * t_buffer, uint8_t t_display, ecdSegmentMask_t t_frame, uint16_t t_holdTime = 0);
+
+/**
+ * Drives displays from frames streamed by a host, without blocking on the stream.
+ *
+ * The Serial and USB cores buffer the incoming bytes from their interrupts. update() only
+ * reads what's already buffered, up to FRAME_MAX_BYTES_PER_POLL bytes, and parses it into
+ * a queue of frames. Bytes can also be given with feed() instead, e.g. from a UART ISR: the
+ * queue has a single producer and a single consumer. Use either begin() or feed(), not both.
+ *
+ * Queued frames for the same display are coalesced: a display busy with an Execute or
+ * holding a frame only executes the latest frame received for it, so a host sending at line
+ * rate never makes a display fall behind. Each display is advanced with YNV_ECD.update().
+ */
+class YNV_FRAME_RECEIVER
+{
+	public:
+		YNV_FRAME_RECEIVER() {}
+
+		bool addDisplay(YNV_ECD_BASE * t_display);			// Gets the next Display ID, from 0
+		void begin(Stream& t_stream) { m_stream = &t_stream; }		// e.g. begin(Serial) after Serial.begin()
+
+		bool feed(uint8_t t_byte);											// Returns true when a frame was just queued
+		bool update(unsigned long t_now);								// Returns true when no frame is pending and no display is driving
+		bool poll() { return update(ynvHalMillis()); }
+
+		uint32_t getFrameCount() const { return m_frameCount; }								// Frames executed
+		uint32_t getCoalescedCount() const { return m_coalescedCount; }				// Frames replaced by a newer one before being executed
+		uint16_t getErrorCount() const { return m_errorCount; }								// Frames dropped on a bad Checksum or Display ID
+		uint16_t getDroppedCount() const { return m_queue.getDroppedCount(); }	// Frames lost because the queue was full
+		ecdFrameParserState_e getState() const { return m_state; }
+
+	private:
+		YNV_ECD_BASE * 			m_displays[FRAME_MAX_DISPLAYS];
+		int 								m_numberOfDisplays 	{ 0 };
+		Stream * 						m_stream 						{ nullptr };
+
+		// Frame being received
+		ecdFrameParserState_e m_state 					{ FRAME_PARSER_WAIT_SYNC };
+		ECD_Frame 					m_frame 						{ 0, 0, 0 };
+		uint8_t 						m_header 						{ 0 };
+		uint8_t 						m_maskBytes 				{ 0 };
+		uint8_t 						m_maskIndex 				{ 0 };
+		uint8_t 						m_checkSum 					{ 0 };
+
+		YNV_SPSC_QUEUE<ECD_Frame, FRAME_QUEUE_SIZE> m_queue;
+
+		// Latest frame of each display, bit d = display d
+		ECD_Frame 					m_pending[FRAME_MAX_DISPLAYS];
+		uint8_t 						m_pendingMask 			{ 0 };
+		uint8_t 						m_holdMask 					{ 0 };			// Displays holding their last frame
+		unsigned long 			m_holdStart[FRAME_MAX_DISPLAYS];
+		uint16_t 						m_holdTime[FRAME_MAX_DISPLAYS];
+
+		uint32_t 						m_frameCount 				{ 0 };
+		uint32_t 						m_coalescedCount 		{ 0 };
+		volatile uint16_t 	m_errorCount 				{ 0 };
+
+		void queuePending(void);
+		bool updateDisplay(int t_display, unsigned long t_now);
+};
+
+#endif	// _YNVISIBLE_FRAME_INPUT
@@ -0,0 +1,37 @@
+/*
+	YnvisibleHAL.h - Hardware access of the Ynvisible Electrochromic Display driver
+	For Driver 5.x Hardware
+*/
+
+#ifndef _YNVISIBLE_HAL
+#define _YNVISIBLE_HAL
+
+#include "Arduino.h"
+
+/**
+ * Pin and time functions used by the driver (YNV_ECD, YNV_ECD_GROUP and the ADC scan).
+ *
+ * On the board they are the Arduino functions, with no overhead.
+ * Define YNV_ECD_HOST to build the driver on a PC: the functions are then provided by the host
+ * program, e.g. the simulated displays in extras/simulation.
+ * @note the SAMD21 register-level paths (YNV_ADC_FAST_SCAN, YNV_ECD_FAST_GPIO) bypass these functions
+ */
+#if defined(YNV_ECD_HOST)
+void 					ynvHalPinMode(uint32_t t_pin, uint32_t t_mode);
+void 					ynvHalDigitalWrite(uint32_t t_pin, uint32_t t_value);
+int 					ynvHalAnalogRead(uint32_t t_pin);
+void 					ynvHalAnalogWrite(uint32_t t_pin, uint32_t t_value);
+void 					ynvHalDelay(unsigned long t_ms);
+unsigned long ynvHalMillis(void);
+void 					ynvHalYield(void);
+#else
+#define ynvHalPinMode(t_pin, t_mode)					pinMode(t_pin, t_mode)
+#define ynvHalDigitalWrite(t_pin, t_value)		digitalWrite(t_pin, t_value)
+#define ynvHalAnalogRead(t_pin)								analogRead(t_pin)
+#define ynvHalAnalogWrite(t_pin, t_value)			analogWrite(t_pin, t_value)
+#define ynvHalDelay(t_ms)											delay(t_ms)
+#define ynvHalMillis()												millis()
+#define ynvHalYield()													yield()
+#endif
+
+#endif	// _YNVISIBLE_HAL
@@ -0,0 +1,108 @@
+/**
+ * Sleep between Refreshes of Ynvisible Electrochromic Displays
+ * 
+ * The wake-up time comes from YNV_ECD.nextRefreshDueMs(), the decay prediction of
+ * each display, so the MCU only wakes up when a segment is about to fade.
+ */
+#include "Arduino.h"
+#include "YnvisiblePower.h"
+
+/**
+ * @brief Add a display to be refreshed on wake-up
+ * 
+ * @param t_display display, must stay valid while the manager is used
+ * @return false if the manager is full
+ */
+bool YNV_POWER_MANAGER::addDisplay(YNV_ECD_BASE * t_display){
+  if(t_display == nullptr || m_numberOfDisplays >= POWER_MAX_DISPLAYS){
+    return false;
+  }
+  m_displays[m_numberOfDisplays] = t_display;
+  m_numberOfDisplays++;
+  return true;
+}
+
+/**
+ * @brief Get the earliest predicted Refresh of the displays
+ * 
+ * @return millis() at which the next Refresh is due, at most setMaxSleepTime() from now
+ */
+unsigned long YNV_POWER_MANAGER::nextWakeUpMs(){
+  unsigned long now = ynvHalMillis();
+  unsigned long sleepTime = m_maxSleepTime;
+
+  for (int i = 0; i < m_numberOfDisplays; i++) {
+    long dueIn = (long)(m_displays[i]->nextRefreshDueMs() - now);
+    if(dueIn <= 0){
+      return now;
+    }
+    if((unsigned long)dueIn < sleepTime){
+      sleepTime = dueIn;
+    }
+  }
+  return now + sleepTime;
+}
+
+/**
+ * @brief Sleep until the next Refresh is due or wake() is called
+ * 
+ * Sets the Counter Electrode and the segments of every display to High-Impedance,
+ * sleeps, and then refreshes the displays whose Refresh is due.
+ * 
+ * @return false if a display was being driven, nothing is done in that case
+ */
+bool YNV_POWER_MANAGER::sleep(){
+  for (int i = 0; i < m_numberOfDisplays; i++) {
+    if(m_displays[i]->isBusy()){
+      return false;
+    }
+  }
+
+  unsigned long sleepTime = nextWakeUpMs() - ynvHalMillis();
+
+  if(sleepTime >= POWER_MIN_SLEEP_TIME && m_wakeRequested == false){
+    for (int i = 0; i < m_numberOfDisplays; i++) {
+      m_displays[i]->disableAllSegments();
+      m_displays[i]->disableCounterElectrode();
+    }
+
+    if(m_sleepHook != nullptr){
+      m_sleepHook(sleepTime);
+    }
+    else{
+      idleSleep(sleepTime);
+    }
+  }
+  m_wakeRequested = false;
+
+  refreshDueDisplays();
+  return true;
+}
+
+/**
+ * @brief Default sleep, the core clocks keep running so millis() stays valid
+ */
+void YNV_POWER_MANAGER::idleSleep(unsigned long t_sleepTime){
+  unsigned long start = ynvHalMillis();
+
+  while((ynvHalMillis() - start) < t_sleepTime && m_wakeRequested == false){
+#if defined(ARDUINO_ARCH_SAMD)
+    __WFI();          // Woken up by the SysTick or any other interrupt
+#else
+    ynvHalYield();
+#endif
+  }
+}
+
+/**
+ * @brief Refresh the displays whose Refresh is due
+ * 
+ * The displays share the Counter Electrode, so they are refreshed one at a time.
+ */
+void YNV_POWER_MANAGER::refreshDueDisplays(){
+  for (int i = 0; i < m_numberOfDisplays; i++) {
+    if(m_displays[i]->isRefreshDue(ynvHalMillis())){
+      m_displays[i]->refreshDisplay();
+    }
+  }
+}
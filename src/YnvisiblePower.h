@@ -0,0 +1,56 @@
+/*
+	YnvisiblePower.h - Sleep between Refreshes of Ynvisible's Electrochromic Displays
+	For Driver 5.x Hardware
+*/
+
+#ifndef _YNVISIBLE_POWER
+#define _YNVISIBLE_POWER
+
+#include "Arduino.h"
+#include "YnvisibleECD.h"
+
+#define POWER_MAX_DISPLAYS				6
+#define POWER_MIN_SLEEP_TIME			5				// ms - Shorter sleeps are skipped
+
+/**
+ * Puts the MCU to sleep for up to t_sleepTime ms.
+ * It may return earlier, e.g. on a button interrupt. The Refresh scheduling uses
+ * millis(), so a hook that stops the millis() timer must not be used for long sleeps.
+ */
+typedef void (*ecdSleepHook_t)(unsigned long t_sleepTime);
+
+/**
+ * Sleeps until the earliest predicted Refresh of a set of displays.
+ * 
+ * The displays are bistable: while sleeping the Counter Electrode and every segment
+ * pin are left in High-Impedance, and after waking up only the displays whose
+ * Refresh is due (YNV_ECD.isRefreshDue()) are refreshed, one at a time.
+ * 
+ * Without a sleep hook the MCU idles with WFI (SAMD) until the deadline or wake() is called.
+ * Use setSleepHook() to plug in a deeper sleep, e.g. from a low-power library.
+ */
+class YNV_POWER_MANAGER
+{
+	public:
+		YNV_POWER_MANAGER() {}
+
+		bool addDisplay(YNV_ECD_BASE * t_display);
+		void setSleepHook(ecdSleepHook_t t_hook) { m_sleepHook = t_hook; }
+		void setMaxSleepTime(unsigned long t_maxSleepTime) { m_maxSleepTime = t_maxSleepTime; }
+
+		unsigned long nextWakeUpMs();							// millis() of the earliest Refresh due
+		bool sleep();															// Sleep and run the due Refreshes. Returns false if a display was busy
+		void wake() { m_wakeRequested = true; }		// Can be called from an ISR to end the sleep early
+		
+	private:
+		YNV_ECD_BASE * 			m_displays[POWER_MAX_DISPLAYS];
+		int 								m_numberOfDisplays 	{ 0 };
+		ecdSleepHook_t 			m_sleepHook 				{ nullptr };
+		unsigned long 			m_maxSleepTime 			{ REFRESH_MAX_INTERVAL };	// ms - Longest single sleep
+		volatile bool 			m_wakeRequested 		{ false };
+
+		void idleSleep(unsigned long t_sleepTime);
+		void refreshDueDisplays();
+};
+
+#endif	// _YNVISIBLE_POWER
@@ -0,0 +1,79 @@
+/*
+	YnvisibleQueue.h - Interrupt-safe queue between an ISR and the main loop
+	For Driver 5.x Hardware
+*/
+
+#ifndef _YNVISIBLE_QUEUE
+#define _YNVISIBLE_QUEUE
+
+#include "Arduino.h"
+
+// Keeps the compiler from moving the item copy across the index update
+#define YNV_QUEUE_BARRIER()		__asm__ __volatile__("" ::: "memory")
+
+/**
+ * Single-producer/single-consumer ring buffer.
+ * One side (e.g. a button ISR) only calls push(), the other side (the main loop)
+ * only calls pop(), peek() and clear(). No interrupts are disabled: each index is
+ * only written by one side and is a single byte, so reads and writes are atomic.
+ * @tparam T item type, copied in and out
+ * @tparam SIZE number of slots, a power of two from 2 to 128. Holds SIZE-1 items.
+ */
+template <typename T, uint8_t SIZE>
+class YNV_SPSC_QUEUE
+{
+	static_assert(SIZE >= 2 && SIZE <= 128 && (SIZE & (SIZE - 1)) == 0, "YNV_SPSC_QUEUE size must be a power of two from 2 to 128");
+
+	public:
+		YNV_SPSC_QUEUE() {}
+
+		// Producer side
+		bool push(const T & t_item){
+			uint8_t head = m_head;
+			uint8_t next = (head + 1) & (SIZE - 1);
+
+			if(next == m_tail){
+				m_dropped++;			// Full, the item is lost
+				return false;
+			}
+			m_items[head] = t_item;
+			YNV_QUEUE_BARRIER();
+			m_head = next;
+			return true;
+		}
+
+		// Consumer side
+		bool pop(T & t_item){
+			uint8_t tail = m_tail;
+
+			if(tail == m_head){
+				return false;
+			}
+			t_item = m_items[tail];
+			YNV_QUEUE_BARRIER();
+			m_tail = (tail + 1) & (SIZE - 1);
+			return true;
+		}
+
+		bool peek(T & t_item) const{
+			if(m_tail == m_head){
+				return false;
+			}
+			t_item = m_items[m_tail];
+			return true;
+		}
+
+		void clear() { m_tail = m_head; }
+
+		bool isEmpty() const { return m_tail == m_head; }
+		uint8_t count() const { return (m_head - m_tail) & (SIZE - 1); }
+		uint16_t getDroppedCount() const { return m_dropped; }		// Items refused because the queue was full
+
+	private:
+		T 								m_items[SIZE];
+		volatile uint8_t 	m_head 			{ 0 };			// Next slot to write, only changed by push()
+		volatile uint8_t 	m_tail 			{ 0 };			// Next slot to read, only changed by pop() and clear()
+		volatile uint16_t m_dropped 	{ 0 };
+};
+
+#endif	// _YNVISIBLE_QUEUE
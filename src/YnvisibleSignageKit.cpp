@@ -129,4 +129,775 @@ uint16_t YNV_SIGNAGE_I2C_MESSAGE::getTotalSize(void){
 
 void YNV_SIGNAGE_I2C_MESSAGE::calculateTotalSize(void){
     m_totalSize = m_length + 6;     // Only the lenght is variable because of the Display Data Bytes
-}
\ No newline at end of file
+}
+
+YNV_SIGNAGE_I2C_STATIC_MESSAGE::YNV_SIGNAGE_I2C_STATIC_MESSAGE(uint8_t * t_buffer, uint16_t t_bufferSize){
+    m_messageBufferTX = t_buffer;
+    m_bufferSize = t_bufferSize;
+}
+
+bool YNV_SIGNAGE_I2C_STATIC_MESSAGE::setLength(uint16_t t_length){
+    if(t_length < SIGN_MESSAGE_MIN_LENGTH || t_length > getMaxLength()){
+        return false;
+    }
+
+    // Keep the Checksum in sync: removed bytes leave the sum, new bytes start at zero
+    for(uint16_t i = t_length; i < m_length; i++){
+        m_dataSum -= m_messageBufferTX[i+3];
+    }
+    for(uint16_t i = m_length; i < t_length; i++){
+        m_messageBufferTX[i+3] = 0;
+    }
+
+    m_length = t_length;
+    return true;
+}
+
+bool YNV_SIGNAGE_I2C_STATIC_MESSAGE::setMessageMode(int t_messageMode){
+    if(t_messageMode == SIGN_MODE_SEGMENTS || t_messageMode == SIGN_MODE_ASCII || t_messageMode == SIGN_MODE_DELTA || t_messageMode == SIGN_MODE_SYNC){
+        m_messageMode = t_messageMode;
+        return true;
+    }
+    return false;
+}
+
+bool YNV_SIGNAGE_I2C_STATIC_MESSAGE::setInputMode(int t_inputMode){
+    if(t_inputMode == SIGN_INPUT_KEYBOARD || t_inputMode == SIGN_INPUT_ASCII || t_inputMode == SIGN_INPUT_SEGMENTS || t_inputMode == SIGN_INPUT_CLEAR_ALL){
+        m_inputMode = t_inputMode;
+        return true;
+    }
+    return false;
+}
+
+bool YNV_SIGNAGE_I2C_STATIC_MESSAGE::setNumberOfDisplays(int t_numDisplays){
+    if(t_numDisplays >= 1 && t_numDisplays <= 255){
+        m_numDisplays = t_numDisplays;
+        return true;
+    }
+    return false;
+}
+
+bool YNV_SIGNAGE_I2C_STATIC_MESSAGE::setDisplayData(char t_data, int t_position){
+    return setDisplayData(&t_data, t_position, 1);
+}
+
+bool YNV_SIGNAGE_I2C_STATIC_MESSAGE::setDisplayData(const char * t_data, int t_position, int t_size){
+    // Display Data goes from Byte 5 to Byte n = m_length + 2
+    if(t_position < SIGN_MESSAGE_DATA_START || t_size < 0 || (t_position + t_size) > (m_length + 3)){
+        return false;
+    }
+
+    for(int i = 0; i < t_size; i++){
+        m_dataSum -= m_messageBufferTX[t_position + i];
+        m_messageBufferTX[t_position + i] = t_data[i];
+        m_dataSum += m_messageBufferTX[t_position + i];
+    }
+
+    return true;
+}
+
+uint16_t YNV_SIGNAGE_I2C_STATIC_MESSAGE::getMessageLength(void) const{
+    return m_length;
+}
+
+uint8_t YNV_SIGNAGE_I2C_STATIC_MESSAGE::getMessageMode(void) const{
+    return m_messageMode;
+}
+
+uint8_t YNV_SIGNAGE_I2C_STATIC_MESSAGE::getInputMode(void) const{
+    return m_inputMode;
+}
+
+uint8_t YNV_SIGNAGE_I2C_STATIC_MESSAGE::getNumberOfDisplays(void) const{
+    return m_numDisplays;
+}
+
+uint8_t * YNV_SIGNAGE_I2C_STATIC_MESSAGE::getMessage(void){
+    uint16_t totalSize = getTotalSize();
+    uint16_t checkSum = m_dataSum + m_numDisplays + m_messageMode;
+
+    if(getMaxLength() == 0){
+        return nullptr;                                     // Buffer can't hold an empty message
+    }
+
+    m_messageBufferTX[0] = SIGN_MESSAGE_START_TX;
+    m_messageBufferTX[1] = m_length >> 8;
+    m_messageBufferTX[2] = m_length & 0xFF;
+
+    m_messageBufferTX[3] = m_numDisplays;
+    m_messageBufferTX[4] = m_messageMode;
+
+    m_messageBufferTX[totalSize-3] = (checkSum >> 8);      // Add CheckSum MSB
+    m_messageBufferTX[totalSize-2] = checkSum & 0xFF;      // Add CheckSum LSB
+
+    m_messageBufferTX[totalSize-1] = SIGN_MESSAGE_END_TX;  // Add End TX byte
+
+    return m_messageBufferTX;
+}
+
+uint16_t YNV_SIGNAGE_I2C_STATIC_MESSAGE::getTotalSize(void) const{
+    return m_length + SIGN_MESSAGE_FRAME_SIZE;
+}
+
+uint16_t YNV_SIGNAGE_I2C_STATIC_MESSAGE::getMaxLength(void) const{
+    if(m_bufferSize < SIGN_MESSAGE_MIN_LENGTH + SIGN_MESSAGE_FRAME_SIZE){
+        return 0;
+    }
+    return m_bufferSize - SIGN_MESSAGE_FRAME_SIZE;
+}
+
+const uint8_t * YNV_SIGNAGE_I2C_STATIC_MESSAGE::getDisplayData(void) const{
+    return &m_messageBufferTX[SIGN_MESSAGE_DATA_START];
+}
+
+/**
+ * @brief Fill the message with the SIGN_MODE_DELTA runs from one Display Data to another
+ * 
+ * Changed bytes closer than SIGN_DELTA_MERGE_GAP are sent in the same run.
+ * 
+ * @param t_previous Display Data the receivers already have
+ * @param t_current new Display Data
+ * @param t_dataSize Display Data bytes, the same for both
+ * @param t_numDisplays Number of Displays in the chain
+ * @return false if the delta isn't smaller than the full Display Data or doesn't fit the buffer.
+ * The message content is undefined in that case.
+ */
+bool YNV_SIGNAGE_I2C_STATIC_MESSAGE::setDelta(const uint8_t * t_previous, const uint8_t * t_current, uint16_t t_dataSize, uint8_t t_numDisplays){
+    if(t_numDisplays == 0 || (t_dataSize % t_numDisplays) != 0 || getMaxLength() == 0){
+        return false;
+    }
+
+    uint16_t bytesPerDisplay = t_dataSize / t_numDisplays;
+    uint16_t maxSize = getMaxLength() - SIGN_MESSAGE_MIN_LENGTH;
+    uint8_t * data = &m_messageBufferTX[SIGN_MESSAGE_DATA_START];
+    uint16_t size = 0;
+    uint16_t dataSum = 0;
+
+    if(bytesPerDisplay > 256){
+        return false;                                       // Offset is a single byte
+    }
+    if(maxSize > t_dataSize){
+        maxSize = t_dataSize;
+    }
+
+    for(uint16_t display = 0; display < t_numDisplays; display++){
+        const uint8_t * previous = &t_previous[display * bytesPerDisplay];
+        const uint8_t * current = &t_current[display * bytesPerDisplay];
+
+        uint16_t i = 0;
+        while(i < bytesPerDisplay){
+            if(previous[i] == current[i]){
+                i++;
+                continue;
+            }
+
+            // Extend the run over small gaps of unchanged bytes
+            uint16_t start = i;
+            uint16_t end = i + 1;
+            for(uint16_t j = end; j < bytesPerDisplay && (j - start) < SIGN_DELTA_MAX_RUN && (j - end) < SIGN_DELTA_MERGE_GAP; j++){
+                if(previous[j] != current[j]){
+                    end = j + 1;
+                }
+            }
+
+            uint16_t count = end - start;
+            if(size + SIGN_DELTA_RUN_HEADER_SIZE + count >= maxSize){
+                return false;
+            }
+
+            data[size++] = display;
+            data[size++] = start;
+            data[size++] = count;
+            dataSum += display + start + count;
+            for(uint16_t k = start; k < end; k++){
+                data[size++] = current[k];
+                dataSum += current[k];
+            }
+            i = end;
+        }
+    }
+
+    m_length = size + SIGN_MESSAGE_MIN_LENGTH;
+    m_numDisplays = t_numDisplays;
+    m_messageMode = SIGN_MODE_DELTA;
+    m_dataSum = dataSum;
+    return true;
+}
+
+
+YNV_SIGNAGE_I2C_TX::YNV_SIGNAGE_I2C_TX(uint8_t t_address, TwoWire & t_wire) : m_wire(t_wire){
+    m_address = t_address;
+}
+
+/**
+ * @brief Queue a message to be sent by update()
+ * 
+ * @param t_message message bytes, kept until the transfer is done
+ * @param t_size number of bytes
+ * @return false if a transfer is already running or the message is empty
+ */
+bool YNV_SIGNAGE_I2C_TX::beginTransmit(const uint8_t * t_message, uint16_t t_size){
+    if(isBusy() || t_message == nullptr || t_size == 0){
+        return false;
+    }
+
+    m_message = t_message;
+    m_size = t_size;
+    m_sent = 0;
+    m_lastError = 0;
+    return true;
+}
+
+bool YNV_SIGNAGE_I2C_TX::beginTransmit(YNV_SIGNAGE_I2C_STATIC_MESSAGE & t_message){
+    return beginTransmit(t_message.getMessage(), t_message.getTotalSize());
+}
+
+/**
+ * @brief Send the next chunk of the queued message
+ * 
+ * The first chunk waits for the resync delay if the previous transfer failed or was cancelled.
+ * 
+ * @return true when the whole message was sent, or the transfer stopped on an error
+ */
+bool YNV_SIGNAGE_I2C_TX::update(void){
+    if(isBusy() == false){
+        return true;
+    }
+    if(m_resync){
+        if(millis() - m_abortTime <= m_resyncDelay){
+            return false;
+        }
+        m_resync = false;
+    }
+
+    uint16_t chunk = m_size - m_sent;
+    if(chunk > m_chunkSize){
+        chunk = m_chunkSize;
+    }
+
+    m_wire.beginTransmission(m_address);
+    m_wire.write(&m_message[m_sent], chunk);
+    m_lastError = m_wire.endTransmission();
+
+    if(m_lastError != 0){
+        abortFrame();                       // Part of the chunk may have been received
+        return true;
+    }
+
+    m_sent += chunk;
+    if(m_sent >= m_size){
+        m_message = nullptr;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Send a message and wait for the transfer to finish
+ * 
+ * @return true if every chunk was acknowledged
+ */
+bool YNV_SIGNAGE_I2C_TX::transmit(const uint8_t * t_message, uint16_t t_size){
+    if(beginTransmit(t_message, t_size) == false){
+        return false;
+    }
+    while(update() == false){
+        yield();
+    }
+    return m_lastError == 0;
+}
+
+/**
+ * @brief Stop the transfer, the rest of the message isn't sent
+ * 
+ * If chunks were sent already, the receiver drops them once it got no byte for its byte
+ * timeout: the next transfer waits for the resync delay first. A receiver that was sent
+ * SIGN_MODE_DELTA messages still needs a full one, see YNV_SIGNAGE_I2C_DELTA_MESSAGE_T::invalidate().
+ */
+void YNV_SIGNAGE_I2C_TX::cancel(void){
+    if(isBusy() && m_sent > 0){
+        abortFrame();
+    }
+    m_message = nullptr;
+}
+
+void YNV_SIGNAGE_I2C_TX::setChunkSize(uint16_t t_chunkSize){
+    if(t_chunkSize == 0 || t_chunkSize > SIGN_I2C_CHUNK_SIZE){
+        t_chunkSize = SIGN_I2C_CHUNK_SIZE;
+    }
+    m_chunkSize = t_chunkSize;
+}
+
+void YNV_SIGNAGE_I2C_TX::setResyncDelay(unsigned long t_delay){
+    m_resyncDelay = t_delay;
+}
+
+bool YNV_SIGNAGE_I2C_TX::isBusy(void) const{
+    return m_message != nullptr;
+}
+
+uint8_t YNV_SIGNAGE_I2C_TX::getLastError(void) const{
+    return m_lastError;
+}
+
+uint16_t YNV_SIGNAGE_I2C_TX::getBytesSent(void) const{
+    return m_sent;
+}
+
+/**
+ * @brief End a transfer that left a partial frame at the receiver
+ */
+void YNV_SIGNAGE_I2C_TX::abortFrame(void){
+    m_message = nullptr;
+    m_resync = true;
+    m_abortTime = millis();
+}
+
+
+YNV_SIGNAGE_I2C_FANOUT::YNV_SIGNAGE_I2C_FANOUT(TwoWire & t_wire) : m_broadcastTx(SIGN_I2C_GENERAL_CALL, t_wire){
+    m_syncMessage.setMessageMode(SIGN_MODE_SYNC);
+}
+
+/**
+ * @brief Add the next board of the logical display
+ * 
+ * @param t_tx transmitter to the board's address, its bus can be shared with other boards
+ * @param t_message message buffer for the board, must hold its Display Data
+ * @param t_numDisplays displays chained on the board
+ * @return false if the logical display is full
+ */
+bool YNV_SIGNAGE_I2C_FANOUT::addBoard(YNV_SIGNAGE_I2C_TX & t_tx, YNV_SIGNAGE_I2C_STATIC_MESSAGE & t_message, uint8_t t_numDisplays){
+    if(m_numBoards >= SIGN_FANOUT_MAX_BOARDS || t_numDisplays == 0 || isBusy()){
+        return false;
+    }
+
+    m_boards[m_numBoards] = &t_tx;
+    m_messages[m_numBoards] = &t_message;
+    m_boardDisplays[m_numBoards] = t_numDisplays;
+    m_numBoards++;
+    m_numDisplays += t_numDisplays;
+    return true;
+}
+
+/**
+ * @brief Split a global frame into the boards' messages and queue them
+ * 
+ * @param t_data Display Data of every display, board by board
+ * @param t_bytesPerDisplay Display Data bytes of each display
+ * @param t_messageMode SIGN_MODE_SEGMENTS or SIGN_MODE_ASCII
+ * @return false if a transfer is running or a board's message can't hold its data
+ */
+bool YNV_SIGNAGE_I2C_FANOUT::beginTransmit(const uint8_t * t_data, uint16_t t_bytesPerDisplay, int t_messageMode){
+    if(isBusy() || m_numBoards == 0 || t_data == nullptr ||
+       (t_messageMode != SIGN_MODE_SEGMENTS && t_messageMode != SIGN_MODE_ASCII)){
+        return false;
+    }
+    for(uint8_t b = 0; b < m_numBoards; b++){
+        if(m_boards[b]->isBusy()){
+            return false;
+        }
+    }
+
+    uint16_t offset = 0;
+    for(uint8_t b = 0; b < m_numBoards; b++){
+        YNV_SIGNAGE_I2C_STATIC_MESSAGE & message = *m_messages[b];
+        uint16_t dataSize = m_boardDisplays[b] * t_bytesPerDisplay;
+
+        if(message.setLength(dataSize + SIGN_MESSAGE_MIN_LENGTH) == false){
+            return false;
+        }
+        message.setNumberOfDisplays(m_boardDisplays[b]);
+        message.setMessageMode(t_messageMode);
+        message.setDisplayData((const char *)&t_data[offset], SIGN_MESSAGE_DATA_START, dataSize);
+        offset += dataSize;
+    }
+
+    for(uint8_t b = 0; b < m_numBoards; b++){
+        m_boards[b]->beginTransmit(*m_messages[b]);
+    }
+    m_failedMask = 0;
+    m_sending = true;
+    return true;
+}
+
+/**
+ * @brief Send one chunk to every board still receiving, then the sync
+ * 
+ * @return true when the transfer is done. getFailedMask() tells if it failed.
+ */
+bool YNV_SIGNAGE_I2C_FANOUT::update(void){
+    if(m_sending == false){
+        return true;
+    }
+
+    bool done = true;
+    for(uint8_t b = 0; b < m_numBoards; b++){
+        if(m_boards[b]->update() == false){
+            done = false;
+        }
+    }
+    if(done == false){
+        return false;
+    }
+
+    m_sending = false;
+    for(uint8_t b = 0; b < m_numBoards; b++){
+        if(m_boards[b]->getLastError() != 0){
+            m_failedMask |= 1 << b;
+        }
+    }
+    if(m_failedMask == 0){
+        sync();
+    }
+    return true;
+}
+
+bool YNV_SIGNAGE_I2C_FANOUT::transmit(const uint8_t * t_data, uint16_t t_bytesPerDisplay, int t_messageMode){
+    if(beginTransmit(t_data, t_bytesPerDisplay, t_messageMode) == false){
+        return false;
+    }
+    while(update() == false){
+        yield();
+    }
+    return m_failedMask == 0;
+}
+
+/**
+ * @brief Make every board execute its held frame
+ * 
+ * The sync messages are sent back to back, without returning to the sketch in between.
+ * 
+ * @return false if a board didn't acknowledge it
+ */
+bool YNV_SIGNAGE_I2C_FANOUT::sync(void){
+    uint8_t * message = m_syncMessage.getMessage();
+    uint16_t size = m_syncMessage.getTotalSize();
+
+    if(isBusy()){
+        return false;
+    }
+    if(m_broadcastSync){
+        return m_broadcastTx.transmit(message, size);
+    }
+
+    bool synced = true;
+    for(uint8_t b = 0; b < m_numBoards; b++){
+        if(m_boards[b]->transmit(message, size) == false){
+            m_failedMask |= 1 << b;
+            synced = false;
+        }
+    }
+    return synced;
+}
+
+/**
+ * @brief Stop the transfer to every board, no sync is sent
+ * 
+ * Each board drops its partial frame on its byte timeout, the boards' transmitters
+ * wait for their resync delay before the next transfer.
+ */
+void YNV_SIGNAGE_I2C_FANOUT::cancel(void){
+    for(uint8_t b = 0; b < m_numBoards; b++){
+        m_boards[b]->cancel();
+    }
+    m_sending = false;
+}
+
+void YNV_SIGNAGE_I2C_FANOUT::setBroadcastSync(bool t_broadcast){
+    m_broadcastSync = t_broadcast;
+}
+
+bool YNV_SIGNAGE_I2C_FANOUT::isBusy(void) const{
+    return m_sending;
+}
+
+uint8_t YNV_SIGNAGE_I2C_FANOUT::getNumberOfBoards(void) const{
+    return m_numBoards;
+}
+
+uint16_t YNV_SIGNAGE_I2C_FANOUT::getNumberOfDisplays(void) const{
+    return m_numDisplays;
+}
+
+uint8_t YNV_SIGNAGE_I2C_FANOUT::getFailedMask(void) const{
+    return m_failedMask;
+}
+
+
+YNV_SIGNAGE_I2C_PARSER::YNV_SIGNAGE_I2C_PARSER(uint8_t * t_buffer, uint16_t t_sliceSize){
+    m_stagedSlice = t_buffer;
+    m_committedSlice = t_buffer + t_sliceSize;
+    m_sliceSize = t_sliceSize;
+}
+
+void YNV_SIGNAGE_I2C_PARSER::setPosition(uint8_t t_position){
+    m_position = t_position;
+}
+
+void YNV_SIGNAGE_I2C_PARSER::setForwardCallback(signForwardCallback_t t_callback){
+    m_forwardCallback = t_callback;
+}
+
+void YNV_SIGNAGE_I2C_PARSER::setSyncMode(bool t_syncMode){
+    m_syncMode = t_syncMode;
+}
+
+/**
+ * @brief Set the longest gap between two bytes of a frame
+ * 
+ * It must be longer than the gaps of the transmitter between two chunks,
+ * and shorter than its resync delay before a frame that follows a failed one.
+ * 
+ * @param t_timeout ms, 0 keeps a partial frame until its Length is received
+ */
+void YNV_SIGNAGE_I2C_PARSER::setByteTimeout(unsigned long t_timeout){
+    m_byteTimeout = t_timeout;
+}
+
+bool YNV_SIGNAGE_I2C_PARSER::feed(uint8_t t_byte){
+    return feed(t_byte, millis());
+}
+
+/**
+ * @brief Decode one received byte
+ * 
+ * Bytes outside a frame are ignored until the next Start TX byte.
+ * A frame with no byte for the byte timeout was cut short by the transmitter: it's
+ * dropped, and this byte is decoded as the first one of a new frame.
+ * 
+ * @param t_byte received byte
+ * @param t_now ms - time of the byte
+ * @return true if this byte completed a valid frame and the local slice can be read.
+ * In sync mode, only when the SIGN_MODE_SYNC message is received.
+ */
+bool YNV_SIGNAGE_I2C_PARSER::feed(uint8_t t_byte, unsigned long t_now){
+    if(m_state != SIGN_PARSER_WAIT_START && m_byteTimeout != 0 && t_now - m_lastByteTime > m_byteTimeout){
+        dropFrame();
+    }
+    m_lastByteTime = t_now;
+
+    if(m_state == SIGN_PARSER_WAIT_START && t_byte != SIGN_MESSAGE_START_TX){
+        return false;
+    }
+    if(m_forwardCallback != nullptr){
+        m_forwardCallback(t_byte);
+    }
+
+    switch(m_state){
+        case SIGN_PARSER_WAIT_START:
+            m_checkSum = 0;
+            m_state = SIGN_PARSER_LENGTH_MSB;
+            break;
+
+        case SIGN_PARSER_LENGTH_MSB:
+            m_length = (uint16_t)t_byte << 8;
+            m_state = SIGN_PARSER_LENGTH_LSB;
+            break;
+
+        case SIGN_PARSER_LENGTH_LSB:
+            m_length |= t_byte;
+            if(m_length < SIGN_MESSAGE_MIN_LENGTH){
+                dropFrame();
+                break;
+            }
+            m_state = SIGN_PARSER_NUM_DISPLAYS;
+            break;
+
+        case SIGN_PARSER_NUM_DISPLAYS:
+            m_checkSum += t_byte;
+            m_numDisplays = t_byte;
+            m_state = SIGN_PARSER_MESSAGE_MODE;
+            break;
+
+        case SIGN_PARSER_MESSAGE_MODE:
+            m_checkSum += t_byte;
+            m_messageMode = t_byte;
+            startDisplayData();
+            break;
+
+        case SIGN_PARSER_DISPLAY_DATA:
+            m_checkSum += t_byte;
+            if(m_messageMode == SIGN_MODE_DELTA){
+                receiveDelta(t_byte);
+            }
+            else if(m_dataIndex >= m_sliceStart && m_dataIndex - m_sliceStart < m_stagedLength){
+                m_stagedSlice[m_dataIndex - m_sliceStart] = t_byte;
+            }
+            m_dataIndex++;
+            if(m_dataIndex >= m_length - SIGN_MESSAGE_MIN_LENGTH){
+                m_state = SIGN_PARSER_CHECKSUM_MSB;
+            }
+            break;
+
+        case SIGN_PARSER_CHECKSUM_MSB:
+            m_receivedCheckSum = (uint16_t)t_byte << 8;
+            m_state = SIGN_PARSER_CHECKSUM_LSB;
+            break;
+
+        case SIGN_PARSER_CHECKSUM_LSB:
+            m_receivedCheckSum |= t_byte;
+            m_state = SIGN_PARSER_END_TX;
+            break;
+
+        case SIGN_PARSER_END_TX:
+            if(t_byte != SIGN_MESSAGE_END_TX || m_receivedCheckSum != m_checkSum){
+                dropFrame();
+                break;
+            }
+            if(m_messageMode == SIGN_MODE_SYNC){
+                return releaseFrame();
+            }
+            commitFrame();
+            return m_available;
+    }
+    return false;
+}
+
+void YNV_SIGNAGE_I2C_PARSER::reset(void){
+    m_state = SIGN_PARSER_WAIT_START;
+}
+
+bool YNV_SIGNAGE_I2C_PARSER::available(void) const{
+    return m_available;
+}
+
+/**
+ * @brief Copy the last committed slice and mark it as read
+ * 
+ * @param t_data output buffer
+ * @param t_size output buffer size, longer slices are truncated
+ * @return number of bytes copied
+ */
+uint16_t YNV_SIGNAGE_I2C_PARSER::readSlice(uint8_t * t_data, uint16_t t_size){
+    noInterrupts();                     // feed() may run in the Wire ISR
+    uint16_t length = m_committedLength;
+    if(length > t_size){
+        length = t_size;
+    }
+    for(uint16_t i = 0; i < length; i++){
+        t_data[i] = m_committedSlice[i];
+    }
+    m_available = false;
+    interrupts();
+
+    return length;
+}
+
+uint8_t YNV_SIGNAGE_I2C_PARSER::getMessageMode(void) const{
+    return m_committedMode;
+}
+
+uint8_t YNV_SIGNAGE_I2C_PARSER::getNumberOfDisplays(void) const{
+    return m_committedNumDisplays;
+}
+
+uint16_t YNV_SIGNAGE_I2C_PARSER::getErrorCount(void) const{
+    return m_errorCount;
+}
+
+signageParserState_e YNV_SIGNAGE_I2C_PARSER::getState(void) const{
+    return m_state;
+}
+
+/**
+ * @brief Locate the local slice once the header is known
+ */
+void YNV_SIGNAGE_I2C_PARSER::startDisplayData(void){
+    uint16_t dataSize = m_length - SIGN_MESSAGE_MIN_LENGTH;
+    uint16_t bytesPerDisplay = m_numDisplays > 0 ? dataSize / m_numDisplays : 0;
+
+    m_dataIndex = 0;
+    m_state = (dataSize > 0) ? SIGN_PARSER_DISPLAY_DATA : SIGN_PARSER_CHECKSUM_MSB;
+
+    if(m_messageMode == SIGN_MODE_SYNC){
+        m_stagedLength = 0;
+        return;
+    }
+
+    if(m_messageMode == SIGN_MODE_DELTA){
+        // Start from the committed slice and patch it with the runs
+        m_stagedLength = m_committedLength;
+        for(uint16_t i = 0; i < m_stagedLength; i++){
+            m_stagedSlice[i] = m_committedSlice[i];
+        }
+        m_runField = 0;
+        return;
+    }
+
+    m_sliceStart = m_position * bytesPerDisplay;
+    m_stagedLength = (m_position < m_numDisplays) ? bytesPerDisplay : 0;
+    if(m_stagedLength > m_sliceSize){
+        m_stagedLength = m_sliceSize;
+    }
+}
+
+/**
+ * @brief Decode one byte of SIGN_MODE_DELTA Display Data
+ */
+void YNV_SIGNAGE_I2C_PARSER::receiveDelta(uint8_t t_byte){
+    switch(m_runField){
+        case 0:
+            m_runIndex = t_byte;
+            m_runField = 1;
+            break;
+
+        case 1:
+            m_runOffset = t_byte;
+            m_runField = 2;
+            break;
+
+        case 2:
+            m_runCount = t_byte;
+            m_runField = (m_runCount > 0) ? 3 : 0;
+            break;
+
+        default:
+            if(m_runIndex == m_position && m_runOffset < m_stagedLength){
+                m_stagedSlice[m_runOffset] = t_byte;
+            }
+            m_runOffset++;
+            if(--m_runCount == 0){
+                m_runField = 0;
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Make the staged slice the committed one
+ */
+void YNV_SIGNAGE_I2C_PARSER::commitFrame(void){
+    uint8_t * slice = m_committedSlice;
+    m_committedSlice = m_stagedSlice;
+    m_stagedSlice = slice;
+
+    m_committedLength = m_stagedLength;
+    if(m_messageMode != SIGN_MODE_DELTA){
+        m_committedMode = m_messageMode;            // A delta keeps the mode of the message it patches
+        m_committedNumDisplays = m_numDisplays;
+    }
+    m_available = !m_syncMode;                      // The slice it replaced can't be read anymore
+    m_held = m_syncMode;
+
+    m_state = SIGN_PARSER_WAIT_START;
+}
+
+/**
+ * @brief Make the frame held in sync mode available
+ * 
+ * @return false if no frame was waiting for the sync
+ */
+bool YNV_SIGNAGE_I2C_PARSER::releaseFrame(void){
+    m_state = SIGN_PARSER_WAIT_START;
+    if(m_held == false){
+        return false;
+    }
+    m_held = false;
+    m_available = true;
+    return true;
+}
+
+void YNV_SIGNAGE_I2C_PARSER::dropFrame(void){
+    m_errorCount++;
+    m_state = SIGN_PARSER_WAIT_START;
+}
@@ -1,6 +1,9 @@
 #ifndef _YNVISIBLE_SIGNAGE_KIT_
 #define _YNVISIBLE_SIGNAGE_KIT_
 
+#include "Arduino.h"
+#include "Wire.h"
+
 // TODO: change to 10 on negative counter implementation
 #define SIGN_KIT_NUM_ANIMATIONS 12
 
@@ -37,6 +40,54 @@ enum signageKitAnimations_e{
     SIGN_ANIMATION_SERIAL_MONITOR
 };
 
+// I2C Message framing
+#define SIGN_MESSAGE_START_TX                       0x02
+#define SIGN_MESSAGE_END_TX                         0x03
+#define SIGN_MESSAGE_MIN_LENGTH                     2       // Number of Displays + Message Mode
+#define SIGN_MESSAGE_FRAME_SIZE                     6       // Start TX + Length + Checksum + End TX
+#define SIGN_MESSAGE_DATA_START                     5       // Position of the first Display Data byte
+#define SIGN_MESSAGE_BUFFER_SIZE(dataSize)          ((dataSize) + SIGN_MESSAGE_MIN_LENGTH + SIGN_MESSAGE_FRAME_SIZE)
+
+/**
+ * SIGN_MODE_DELTA Display Data
+ * A list of runs, each one is
+ *      [Display Index] [Offset] [Count] [Count bytes of Display Data]
+ * Offset is the position of the first byte inside that display's data.
+ * Bytes not covered by a run keep the value of the last full message.
+ */
+#define SIGN_DELTA_RUN_HEADER_SIZE                  3
+#define SIGN_DELTA_MAX_RUN                          255
+#define SIGN_DELTA_MERGE_GAP                        SIGN_DELTA_RUN_HEADER_SIZE     // Unchanged bytes cheaper to resend than a new run header
+
+// Largest I2C write, limited by the Wire TX buffer
+#if defined(BUFFER_LENGTH)
+#define SIGN_I2C_CHUNK_SIZE                         BUFFER_LENGTH
+#elif defined(SERIAL_BUFFER_SIZE)
+#define SIGN_I2C_CHUNK_SIZE                         SERIAL_BUFFER_SIZE
+#else
+#define SIGN_I2C_CHUNK_SIZE                         32
+#endif
+
+#define SIGN_I2C_GENERAL_CALL                       0x00    // I2C broadcast address
+#define SIGN_FANOUT_MAX_BOARDS                      8
+
+#define SIGN_PARSER_BYTE_TIMEOUT                    100     // ms - Longest gap between two bytes of a frame, the parser drops the frame after it
+#define SIGN_I2C_RESYNC_DELAY                       (SIGN_PARSER_BYTE_TIMEOUT + 10)    // ms - Pause before the frame after a failed one
+
+enum signageParserState_e{
+    SIGN_PARSER_WAIT_START = 0,
+    SIGN_PARSER_LENGTH_MSB,
+    SIGN_PARSER_LENGTH_LSB,
+    SIGN_PARSER_NUM_DISPLAYS,
+    SIGN_PARSER_MESSAGE_MODE,
+    SIGN_PARSER_DISPLAY_DATA,
+    SIGN_PARSER_CHECKSUM_MSB,
+    SIGN_PARSER_CHECKSUM_LSB,
+    SIGN_PARSER_END_TX
+};
+
+typedef void (*signForwardCallback_t)(uint8_t t_byte);     // Called with every byte of a frame, to pass it down the chain
+
 enum signageInputModes_e{
     SIGN_INPUT_KEYBOARD = 1,
     SIGN_INPUT_ASCII,
@@ -50,7 +101,9 @@ enum displayType_e{
 };
 enum signageMessageModes_e{
     SIGN_MODE_SEGMENTS = 0,
-    SIGN_MODE_ASCII
+    SIGN_MODE_ASCII,
+    SIGN_MODE_DELTA,                // Display Data is a list of runs patching the last full message
+    SIGN_MODE_SYNC                  // No Display Data, releases the frame held by a parser in sync mode
 };
 
 /**
@@ -105,4 +158,282 @@ class YNV_SIGNAGE_I2C_MESSAGE
         void calculateTotalSize(void);
 };
 
+/**
+ * I2C Message built in a fixed, caller supplied buffer.
+ * Same message composition as YNV_SIGNAGE_I2C_MESSAGE, without any heap use:
+ * the buffer must hold SIGN_MESSAGE_BUFFER_SIZE(max Display Data bytes).
+ * The Checksum is kept up to date by every setter, so getMessage() only
+ * writes the header and trailer bytes.
+ */
+class YNV_SIGNAGE_I2C_STATIC_MESSAGE
+{
+    public:
+        YNV_SIGNAGE_I2C_STATIC_MESSAGE(uint8_t * t_buffer, uint16_t t_bufferSize);
+
+        bool    setLength(uint16_t t_length);                                   // Set the Message Length parameter, fails if it doesn't fit the buffer
+        bool    setMessageMode(int t_messageMode);
+        bool    setInputMode(int t_inputMode);
+        bool    setNumberOfDisplays(int t_numDisplays);
+        bool    setDisplayData(char t_data, int t_position);
+        bool    setDisplayData(const char * t_data, int t_position, int t_size);
+
+        uint16_t    getMessageLength(void) const;
+        uint8_t     getMessageMode(void) const;
+        uint8_t     getInputMode(void) const;
+        uint8_t     getNumberOfDisplays(void) const;
+        uint8_t *   getMessage(void);
+        uint16_t    getTotalSize(void) const;
+        uint16_t    getMaxLength(void) const;                                   // Largest Length that fits the buffer
+        const uint8_t * getDisplayData(void) const;                             // First Display Data byte
+
+        bool    setDelta(const uint8_t * t_previous, const uint8_t * t_current, uint16_t t_dataSize, uint8_t t_numDisplays);
+
+    private:
+        uint8_t * m_messageBufferTX;
+        uint16_t m_bufferSize;
+
+        uint16_t m_length           { SIGN_MESSAGE_MIN_LENGTH };
+        uint8_t m_messageMode       { SIGN_MODE_ASCII };
+        uint8_t m_inputMode         { SIGN_INPUT_KEYBOARD };
+        uint8_t m_numDisplays       { 0 };
+        uint16_t m_dataSum          { 0 };                                      // Sum of the Display Data bytes
+};
+
+/**
+ * I2C Message with its buffer sized at compile time
+ * @tparam MAX_DATA maximum number of Display Data bytes
+ */
+template <uint16_t MAX_DATA>
+class YNV_SIGNAGE_I2C_MESSAGE_T : public YNV_SIGNAGE_I2C_STATIC_MESSAGE
+{
+    public:
+        YNV_SIGNAGE_I2C_MESSAGE_T() : YNV_SIGNAGE_I2C_STATIC_MESSAGE(m_buffer, sizeof(m_buffer)) {}
+
+    private:
+        uint8_t m_buffer[SIGN_MESSAGE_BUFFER_SIZE(MAX_DATA)];
+};
+
+/**
+ * I2C Message that sends only what changed since the previous message.
+ * Build the full message as usual, then send getUpdateMessage(): it's a
+ * SIGN_MODE_DELTA message against the last one sent, or the full message
+ * when a delta wouldn't be smaller (first message, new length, new mode...).
+ * @tparam MAX_DATA maximum number of Display Data bytes
+ */
+template <uint16_t MAX_DATA>
+class YNV_SIGNAGE_I2C_DELTA_MESSAGE_T : public YNV_SIGNAGE_I2C_MESSAGE_T<MAX_DATA>
+{
+    public:
+        /**
+         * Message to send for the current Display Data. The current data
+         * becomes the reference for the next call.
+         */
+        uint8_t * getUpdateMessage(void){
+            uint16_t dataSize = this->getMessageLength() - SIGN_MESSAGE_MIN_LENGTH;
+            bool useDelta = m_shadowValid && m_shadowLength == this->getMessageLength() && m_shadowMode == this->getMessageMode() &&
+                            m_delta.setDelta(m_shadow, this->getDisplayData(), dataSize, this->getNumberOfDisplays());
+
+            memcpy(m_shadow, this->getDisplayData(), dataSize);
+            m_shadowLength = this->getMessageLength();
+            m_shadowMode = this->getMessageMode();
+            m_shadowValid = true;
+
+            m_updateIsDelta = useDelta;
+            return useDelta ? m_delta.getMessage() : this->getMessage();
+        }
+
+        uint16_t getUpdateSize(void) const{
+            return m_updateIsDelta ? m_delta.getTotalSize() : this->getTotalSize();
+        }
+
+        void invalidate(void){                  // Next update is a full message, e.g. after a receiver reset
+            m_shadowValid = false;
+        }
+
+    private:
+        YNV_SIGNAGE_I2C_MESSAGE_T<MAX_DATA> m_delta;
+        uint8_t m_shadow[MAX_DATA];
+        uint16_t m_shadowLength     { 0 };
+        uint8_t m_shadowMode        { 0 };
+        bool m_shadowValid          { false };
+        bool m_updateIsDelta        { false };
+};
+
+/**
+ * Sends a Signage message over I2C in Wire buffer sized chunks.
+ * Each chunk is its own I2C write to the same address; the Start TX, Length
+ * and End TX bytes let the receiver put the message back together.
+ * beginTransmit() only queues the message. update() sends one chunk per call,
+ * so the sketch can keep running (or build the next message) between chunks.
+ * A failed or cancelled transfer leaves a partial frame at the receiver. The next
+ * transfer waits for the resync delay first, so the receiver's parser drops it on its
+ * byte timeout and takes the next Start TX as a new frame.
+ * @note the message buffer is sent in place and must not change until the transfer is done.
+ */
+class YNV_SIGNAGE_I2C_TX
+{
+    public:
+        YNV_SIGNAGE_I2C_TX(uint8_t t_address, TwoWire & t_wire = Wire);
+
+        bool    beginTransmit(const uint8_t * t_message, uint16_t t_size);      // Queue a message, fails if a transfer is running
+        bool    beginTransmit(YNV_SIGNAGE_I2C_STATIC_MESSAGE & t_message);
+        bool    update(void);                                                   // Send the next chunk. Returns true when there's nothing left to send
+        bool    transmit(const uint8_t * t_message, uint16_t t_size);           // Blocking send, returns false on an I2C error
+        void    cancel(void);
+
+        void    setChunkSize(uint16_t t_chunkSize);                             // Limited to SIGN_I2C_CHUNK_SIZE
+        void    setResyncDelay(unsigned long t_delay);                          // ms - Must be longer than the receiver's byte timeout
+        bool    isBusy(void) const;
+        uint8_t getLastError(void) const;                                       // Wire.endTransmission() result of the last failed chunk, 0 if none
+        uint16_t getBytesSent(void) const;
+
+    private:
+        TwoWire & m_wire;
+        uint8_t m_address;
+        uint16_t m_chunkSize            { SIGN_I2C_CHUNK_SIZE };
+
+        const uint8_t * m_message       { nullptr };
+        uint16_t m_size                 { 0 };
+        uint16_t m_sent                 { 0 };
+        uint8_t m_lastError             { 0 };
+
+        unsigned long m_resyncDelay     { SIGN_I2C_RESYNC_DELAY };
+        unsigned long m_abortTime       { 0 };
+        bool m_resync                   { false };                              // A partial frame was sent, wait before the next one
+
+        void    abortFrame(void);
+};
+
+/**
+ * Logical display spanning several Driver boards, each one on its own I2C address.
+ * The global Display Data lists the displays board by board, in the order of addBoard().
+ * beginTransmit() splits it into one message per board and update() sends them one
+ * chunk per board per call, so every board gets its frame at about the same time.
+ * Once all of them are sent, a SIGN_MODE_SYNC message makes the boards execute
+ * together: their parsers must use setSyncMode(true).
+ * The sync goes to every board back to back, about 0.2 ms apart at 400 kHz, or once to
+ * the I2C General Call address with setBroadcastSync(), if the receivers answer to it.
+ * No sync is sent if a board failed, so the whole display keeps its last frame.
+ */
+class YNV_SIGNAGE_I2C_FANOUT
+{
+    public:
+        YNV_SIGNAGE_I2C_FANOUT(TwoWire & t_wire = Wire);
+
+        bool    addBoard(YNV_SIGNAGE_I2C_TX & t_tx, YNV_SIGNAGE_I2C_STATIC_MESSAGE & t_message, uint8_t t_numDisplays);
+        bool    beginTransmit(const uint8_t * t_data, uint16_t t_bytesPerDisplay, int t_messageMode = SIGN_MODE_SEGMENTS);
+        bool    update(void);                                                   // Send the next chunks, then the sync. Returns true when done
+        bool    transmit(const uint8_t * t_data, uint16_t t_bytesPerDisplay, int t_messageMode = SIGN_MODE_SEGMENTS);     // Blocking send, returns false if a board failed
+        bool    sync(void);                                                     // Only send the sync
+        void    cancel(void);
+
+        void    setBroadcastSync(bool t_broadcast);
+        bool    isBusy(void) const;
+        uint8_t getNumberOfBoards(void) const;
+        uint16_t getNumberOfDisplays(void) const;
+        uint8_t getFailedMask(void) const;                                      // Boards that failed the last transfer, bit b = board b
+
+    private:
+        YNV_SIGNAGE_I2C_TX * m_boards[SIGN_FANOUT_MAX_BOARDS];
+        YNV_SIGNAGE_I2C_STATIC_MESSAGE * m_messages[SIGN_FANOUT_MAX_BOARDS];
+        uint8_t m_boardDisplays[SIGN_FANOUT_MAX_BOARDS];
+        uint8_t m_numBoards             { 0 };
+        uint16_t m_numDisplays          { 0 };
+
+        YNV_SIGNAGE_I2C_TX m_broadcastTx;
+        YNV_SIGNAGE_I2C_MESSAGE_T<0> m_syncMessage;
+        bool m_broadcastSync            { false };
+        bool m_sending                  { false };
+        uint8_t m_failedMask            { 0 };
+};
+
+/**
+ * Decodes Signage messages one byte at a time, e.g. from a Wire.onReceive() handler.
+ * Only the Display Data addressed to this display (its position in the chain) is
+ * stored, so memory use doesn't depend on the chain length. Every display gets
+ * (Length - 2) / Number of Displays bytes. SIGN_MODE_DELTA messages patch the
+ * last committed slice instead.
+ * The slice is staged while the frame arrives and only committed once the
+ * Checksum and End TX byte are valid. The whole frame can be forwarded, byte
+ * by byte, to the next board of the chain.
+ * In sync mode a committed frame is held until a SIGN_MODE_SYNC message, so several
+ * boards driven by YNV_SIGNAGE_I2C_FANOUT update at the same time.
+ * A frame cut short by the transmitter is dropped when no byte comes for the
+ * byte timeout, so the parser is waiting for a Start TX again when the next one starts.
+ * @note the buffer must hold 2 * t_sliceSize bytes: one slice being received, one committed.
+ */
+class YNV_SIGNAGE_I2C_PARSER
+{
+    public:
+        YNV_SIGNAGE_I2C_PARSER(uint8_t * t_buffer, uint16_t t_sliceSize);
+
+        void    setPosition(uint8_t t_position);                                // Position of this display in the chain, 0 is the first one
+        void    setForwardCallback(signForwardCallback_t t_callback);
+        void    setSyncMode(bool t_syncMode);                                   // Hold committed frames until a SIGN_MODE_SYNC message
+        bool    feed(uint8_t t_byte);                                           // Returns true when a valid frame just became available
+        bool    feed(uint8_t t_byte, unsigned long t_now);                      // Same, with the time of the byte in ms
+        void    setByteTimeout(unsigned long t_timeout);                        // ms - 0 never drops a frame on a gap
+        void    reset(void);                                                    // Drop the frame being received
+
+        bool    available(void) const;                                          // A committed slice wasn't read yet
+        uint16_t readSlice(uint8_t * t_data, uint16_t t_size);                  // Copy the committed slice, returns its length
+        uint8_t getMessageMode(void) const;                                     // Mode of the committed frame
+        uint8_t getNumberOfDisplays(void) const;
+        uint16_t getErrorCount(void) const;                                     // Frames dropped on a bad Length, Checksum or End TX, or a timeout
+        signageParserState_e getState(void) const;
+
+    private:
+        uint8_t * m_stagedSlice;
+        uint8_t * m_committedSlice;
+        uint16_t m_sliceSize;
+        uint8_t m_position                          { 0 };
+        signForwardCallback_t m_forwardCallback     { nullptr };
+        bool m_syncMode                             { false };
+        unsigned long m_byteTimeout                 { SIGN_PARSER_BYTE_TIMEOUT };
+
+        // Frame being received
+        unsigned long m_lastByteTime                { 0 };
+        volatile signageParserState_e m_state       { SIGN_PARSER_WAIT_START };
+        uint16_t m_length                           { 0 };
+        uint16_t m_dataIndex                        { 0 };
+        uint16_t m_checkSum                         { 0 };
+        uint16_t m_receivedCheckSum                 { 0 };
+        uint8_t m_numDisplays                       { 0 };
+        uint8_t m_messageMode                       { 0 };
+        uint16_t m_sliceStart                       { 0 };
+        uint16_t m_stagedLength                     { 0 };
+        uint8_t m_runField                          { 0 };          // SIGN_MODE_DELTA: run header byte being received
+        uint8_t m_runIndex                          { 0 };
+        uint16_t m_runOffset                        { 0 };
+        uint8_t m_runCount                          { 0 };
+
+        // Committed frame
+        volatile bool m_available                   { false };
+        volatile bool m_held                        { false };          // Sync mode: committed, waiting for the sync
+        volatile uint16_t m_committedLength         { 0 };
+        volatile uint8_t m_committedMode            { 0 };
+        volatile uint8_t m_committedNumDisplays     { 0 };
+        volatile uint16_t m_errorCount              { 0 };
+
+        void    startDisplayData(void);
+        void    receiveDelta(uint8_t t_byte);
+        void    commitFrame(void);
+        bool    releaseFrame(void);
+        void    dropFrame(void);
+};
+
+/**
+ * Signage parser with its buffers sized at compile time
+ * @tparam SLICE_SIZE maximum number of Display Data bytes for this display
+ */
+template <uint16_t SLICE_SIZE>
+class YNV_SIGNAGE_I2C_PARSER_T : public YNV_SIGNAGE_I2C_PARSER
+{
+    public:
+        YNV_SIGNAGE_I2C_PARSER_T() : YNV_SIGNAGE_I2C_PARSER(m_buffer, SLICE_SIZE) {}
+
+    private:
+        uint8_t m_buffer[2 * SLICE_SIZE];
+};
+
 #endif // _YNVISIBLE_SIGNAGE_KIT
\ No newline at end of file
@@ -0,0 +1,140 @@
+/**
+ * Supply Voltage tracking for Ynvisible Electrochromic Displays
+ *
+ * The DAC codes and refresh limits of each display are computed for a Supply Voltage.
+ * Keeping it up to date avoids over- or under-driving the segments as the rail drifts,
+ * and the extra refresh retries that come with it.
+ */
+#include "Arduino.h"
+#include "YnvisibleADC.h"
+#include "YnvisibleSupply.h"
+
+/**
+ * @brief Supply Voltage monitor, using the internal supply channel when the board has one
+ */
+YNV_SUPPLY_MONITOR::YNV_SUPPLY_MONITOR(){
+#if defined(YNV_ADC_SUPPLY_CHANNEL)
+  m_reader = ynvReadSupplyMillivolts;
+#endif
+}
+
+/**
+ * @brief Add a display to keep up to date
+ *
+ * @param t_display display, must stay valid while the monitor is used
+ * @param t_group group the display was added to, if any. The display isn't updated while the group drives
+ * @return false if the monitor is full
+ */
+bool YNV_SUPPLY_MONITOR::addDisplay(YNV_ECD_BASE * t_display, const YNV_ECD_GROUP * t_group){
+  if(t_display == nullptr || m_numberOfDisplays >= SUPPLY_MAX_DISPLAYS){
+    return false;
+  }
+  if(m_applied != 0){
+    m_pendingMask |= 1 << m_numberOfDisplays;     // Gets the tracked value on the next update()
+  }
+  m_displays[m_numberOfDisplays] = t_display;
+  m_groups[m_numberOfDisplays] = t_group;
+  m_numberOfDisplays++;
+  return true;
+}
+
+/**
+ * @brief Measure the Supply Voltage and give it to the displays
+ *
+ * Call it once at boot, after adding the displays and before driving them.
+ *
+ * @return false if the Supply Voltage couldn't be measured. The displays keep their value
+ */
+bool YNV_SUPPLY_MONITOR::begin(){
+  m_filtered = 0;
+  m_lastSampleTime = ynvHalMillis();
+  if(sample() == false){
+    return false;
+  }
+
+  m_applied = getSupplyMillivolts();
+  m_pendingMask = (1 << m_numberOfDisplays) - 1;
+  applyPending();
+  return true;
+}
+
+/**
+ * @brief Sample the Supply Voltage when due and update the displays if it moved
+ *
+ * Call it periodically, e.g. on every loop() or after waking up. It only uses the ADC
+ * once every setSampleInterval() ms.
+ *
+ * @param t_now current time in ms, usually millis()
+ * @return true if at least one display got a new Supply Voltage
+ */
+bool YNV_SUPPLY_MONITOR::update(unsigned long t_now){
+  if(t_now - m_lastSampleTime >= m_sampleInterval){
+    m_lastSampleTime = t_now;
+
+    if(sample() == true){
+      uint16_t filtered = getSupplyMillivolts();
+      uint16_t change = (filtered > m_applied) ? filtered - m_applied : m_applied - filtered;
+
+      if(change > m_hysteresis){
+        m_applied = filtered;
+        m_pendingMask = (1 << m_numberOfDisplays) - 1;
+      }
+    }
+  }
+  return applyPending();
+}
+
+/**
+ * @brief Take a Supply Voltage sample into the low-pass filter
+ *
+ * @return false if there's no reader or the sample is out of range
+ */
+bool YNV_SUPPLY_MONITOR::sample(){
+  if(m_reader == nullptr){
+    return false;
+  }
+
+  uint16_t supply = m_reader();
+  if(supply < SUPPLY_MIN_VALID || supply > SUPPLY_MAX_VALID){
+    return false;
+  }
+
+  if(m_filtered == 0){
+    m_filtered = (uint32_t)supply << SUPPLY_FILTER_SHIFT;     // First sample
+  }
+  else{
+    m_filtered = m_filtered - (m_filtered >> SUPPLY_FILTER_SHIFT) + supply;
+  }
+  return true;
+}
+
+/**
+ * @brief Check if a display is being driven, on its own or by its group
+ */
+bool YNV_SUPPLY_MONITOR::isDriving(int t_display) const{
+  const YNV_ECD_GROUP * group = m_groups[t_display];
+
+  return m_displays[t_display]->isBusy() || (group != nullptr && group->isBusy());
+}
+
+/**
+ * @brief Give the tracked Supply Voltage to the displays that are not driving
+ *
+ * Busy displays, and displays whose group is busy, are left pending, so their pulses
+ * and limits don't change mid-way.
+ *
+ * @return true if at least one display was updated
+ */
+bool YNV_SUPPLY_MONITOR::applyPending(){
+  bool updated = false;
+
+  for(int d = 0; d < m_numberOfDisplays; d++){
+    if(((m_pendingMask >> d) & 1) == 0 || isDriving(d)){
+      continue;
+    }
+    m_displays[d]->updateSupplyVoltage(m_applied / 1000.0f);
+    m_pendingMask &= ~(1 << d);
+    updated = true;
+  }
+  return updated;
+}
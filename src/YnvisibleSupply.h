@@ -0,0 +1,73 @@
+/*
+	YnvisibleSupply.h - Supply Voltage tracking for Ynvisible's Electrochromic Displays
+	For Driver 5.x Hardware
+*/
+
+#ifndef _YNVISIBLE_SUPPLY
+#define _YNVISIBLE_SUPPLY
+
+#include "Arduino.h"
+#include "YnvisibleECD.h"
+#include "YnvisibleECDGroup.h"
+
+#define SUPPLY_MAX_DISPLAYS				6
+#define SUPPLY_SAMPLE_INTERVAL		10000		// ms - Time between Supply Voltage samples
+#define SUPPLY_FILTER_SHIFT				2				// Low-pass filter weight of each new sample: 1/2^SUPPLY_FILTER_SHIFT
+#define SUPPLY_HYSTERESIS					20			// mV - Filtered change needed to recompute the limits
+#define SUPPLY_MIN_VALID					1600		// mV - Lower samples are taken as a failed measurement
+#define SUPPLY_MAX_VALID					3700		// mV - Higher samples are taken as a failed measurement
+
+/**
+ * Measures the Supply Voltage.
+ * @return mV, 0 if it couldn't be measured
+ */
+typedef uint16_t (*ecdSupplyReader_t)(void);
+
+/**
+ * Tracks the Supply Voltage of a set of displays, e.g. as a battery discharges.
+ *
+ * The rail is sampled every SUPPLY_SAMPLE_INTERVAL ms and low-pass filtered. Only when the
+ * filtered value moves more than SUPPLY_HYSTERESIS away from the one in use are the DAC codes
+ * and refresh limits of every display recomputed (YNV_ECD.updateSupplyVoltage()). Displays
+ * that are driving are updated once they are idle, never in the middle of a pulse.
+ * A display driven by a YNV_ECD_GROUP must be added with its group: the group's pulses
+ * don't make the display itself busy.
+ *
+ * On SAMD21 the internal 1/4 VDDIO channel is used. Other boards need a reader, see setReader().
+ */
+class YNV_SUPPLY_MONITOR
+{
+	public:
+		YNV_SUPPLY_MONITOR();
+
+		bool addDisplay(YNV_ECD_BASE * t_display, const YNV_ECD_GROUP * t_group = nullptr);
+		void setReader(ecdSupplyReader_t t_reader) { m_reader = t_reader; }
+		void setSampleInterval(unsigned long t_interval) { m_sampleInterval = t_interval; }
+		void setHysteresis(uint16_t t_hysteresis) { m_hysteresis = t_hysteresis; }
+
+		bool begin();														// Take the first sample and update the displays right away
+		bool update(unsigned long t_now);				// Returns true when the displays got a new Supply Voltage
+		bool poll() { return update(ynvHalMillis()); }
+
+		uint16_t getSupplyMillivolts() const { return m_filtered >> SUPPLY_FILTER_SHIFT; }
+		uint16_t getAppliedMillivolts() const { return m_applied; }
+
+	private:
+		YNV_ECD_BASE * 			m_displays[SUPPLY_MAX_DISPLAYS];
+		const YNV_ECD_GROUP * m_groups[SUPPLY_MAX_DISPLAYS];		// Group driving each display, nullptr if none
+		int 								m_numberOfDisplays 	{ 0 };
+		ecdSupplyReader_t 	m_reader 						{ nullptr };
+		unsigned long 			m_sampleInterval 		{ SUPPLY_SAMPLE_INTERVAL };
+		uint16_t 						m_hysteresis 				{ SUPPLY_HYSTERESIS };
+
+		unsigned long 			m_lastSampleTime 		{ 0 };
+		uint32_t 						m_filtered 					{ 0 };			// mV << SUPPLY_FILTER_SHIFT
+		uint16_t 						m_applied 					{ 0 };			// mV - Supply Voltage given to the displays
+		uint8_t 						m_pendingMask 			{ 0 };			// Displays still to update, bit d = display d
+
+		bool sample();
+		bool isDriving(int t_display) const;
+		bool applyPending();
+};
+
+#endif	// _YNVISIBLE_SUPPLY